@@ -0,0 +1,21 @@
+#include "ASTArena.h"
+
+ASTArena::ASTArena(size_t blockSize) {
+    m_Cur = nullptr;
+    m_End = nullptr;
+    m_BlockSize = blockSize;
+    m_Used = 0;
+    m_Reserved = 0;
+}
+
+// Starts a new block, the tail of the current one is abandoned. A request larger than the block
+// size gets a block of its own.
+void* ASTArena::allocateSlow(size_t size, size_t align) {
+    size_t length = size + align > m_BlockSize ? size + align : m_BlockSize;
+    m_Blocks.emplace_back(new char[length]);
+    m_Cur = m_Blocks.back().get();
+    m_End = m_Cur + length;
+    m_Reserved += length;
+    if (m_BlockSize < MAX_BLOCK_SIZE) m_BlockSize *= 2;
+    return Allocate(size, align);
+}
@@ -0,0 +1,101 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+class ASTShareTable;
+
+// Fixed size array of children or names, the items live in the ASTArena that made the list.
+template<typename T>
+class ASTList
+{
+    public:
+        ASTList() { m_Items = nullptr; m_Count = 0; }
+        ASTList(T* items, unsigned int count) { m_Items = items; m_Count = count; }
+
+        unsigned int GetCount() const { return m_Count; }
+        bool IsEmpty() const { return m_Count == 0; }
+        T& operator[](size_t index) const { return m_Items[index]; }
+        T* begin() const { return m_Items; }
+        T* end() const { return m_Items + m_Count; }
+
+    private:
+        T* m_Items;
+        unsigned int m_Count;
+};
+
+// Bump pointer allocator for the syntax tree of one compilation unit. Nodes and child arrays are
+// carved out of large blocks and are never freed one by one, the whole tree goes away with the
+// arena. Destructors are not run, so only trivially destructible types may be placed in it.
+class ASTArena
+{
+    public:
+        static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+        static const size_t MAX_BLOCK_SIZE = 1024 * 1024;
+
+        ASTArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+        ASTArena(const ASTArena&) = delete;
+        ASTArena& operator=(const ASTArena&) = delete;
+
+        void* Allocate(size_t size, size_t align) {
+            auto cur = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(m_Cur) + align - 1) & ~(uintptr_t)(align - 1));
+            if (cur + size > m_End) return allocateSlow(size, align);
+            m_Cur = cur + size;
+            m_Used += size;
+            return cur;
+        }
+
+        template<typename T, typename... Args>
+        T* New(Args&&... args) {
+            static_assert(std::is_trivially_destructible<T>::value, "ASTArena never runs destructors");
+            return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        // Copies count items into the arena.
+        template<typename T>
+        ASTList<T> MakeList(const T* items, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value, "ASTList items are copied as bytes");
+            if (count == 0) return ASTList<T>();
+            auto copy = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+            std::memcpy(copy, items, sizeof(T) * count);
+            return ASTList<T>(copy, static_cast<unsigned int>(count));
+        }
+
+        // Gives back the last allocation, a later Allocate reuses the space. Anything else is ignored.
+        void Release(void* memory, size_t size) {
+            if (static_cast<char*>(memory) + size != m_Cur) return;
+            m_Cur = static_cast<char*>(memory);
+            m_Used -= size;
+        }
+
+        // Nodes of the shareable kinds made in this arena are hash consed in table, see ASTShareTable.
+        void SetShareTable(std::shared_ptr<ASTShareTable> table) { m_ShareTable = std::move(table); }
+        ASTShareTable* GetShareTable() const { return m_ShareTable.get(); }
+
+        // Keeps owner alive as long as the arena. Nodes hold views into the source text and the
+        // NameTable instead of copies, the parser registers both here so the views can't dangle.
+        void KeepAlive(std::shared_ptr<const void> owner) { m_Owners.push_back(std::move(owner)); }
+
+        // Bytes handed out, and bytes taken from the heap including the unused tails of blocks.
+        size_t GetBytesUsed() const { return m_Used; }
+        size_t GetBytesReserved() const { return m_Reserved; }
+        size_t GetBlockCount() const { return m_Blocks.size(); }
+
+    private:
+        void* allocateSlow(size_t size, size_t align);
+
+        std::vector<std::unique_ptr<char[]>> m_Blocks;
+        std::vector<std::shared_ptr<const void>> m_Owners;
+        std::shared_ptr<ASTShareTable> m_ShareTable;
+        char* m_Cur;
+        char* m_End;
+        size_t m_BlockSize;                     // Size of the next block, doubles up to MAX_BLOCK_SIZE
+        size_t m_Used;
+        size_t m_Reserved;
+};
@@ -0,0 +1,275 @@
+#include "ASTCache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+#include "ContentHash.h"
+
+static const char CACHE_MAGIC[8] = { 'O', 'B', 'X', 'A', 'S', 'T', '\r', '\n' };
+
+struct CacheHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int headerSize;
+    unsigned long long sourceHash;
+    unsigned long long sourceLength;
+    unsigned int nodesOffset, nodesWords;
+    unsigned int refsOffset, refsWords;
+    unsigned int stringsOffset, stringsBytes;
+    unsigned int root;
+    unsigned int nodeCount;
+};
+
+static_assert(sizeof(CacheHeader) == 64, "The cache header is part of the file format");
+
+// Words of a node record of kind, see the layout in ASTCache.h.
+static unsigned int recordWords(NodeKind kind) {
+    auto& shape = NODE_SHAPES[kind];
+    unsigned int words = 2 + shape.children + shape.lists * 2;
+    switch (shape.payload) {
+        case NP_NAMES:      return words + shape.names;
+        case NP_NAME_LIST:  return words + 2;
+        case NP_NUMBER:     return words + 3;
+        case NP_TEXT:       return words + 1;
+        default:            return words;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Writing ////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+class CacheWriter
+{
+    public:
+        CacheWriter(const NameTable& names, bool isPositioned) : m_Names(names) { m_NodeCount = 0; m_IsPositioned = isPositioned; }
+
+        unsigned int WriteNode(const ASTNode* node);
+        bool WriteFile(FILE* file, unsigned int root, unsigned long long sourceHash, unsigned long long sourceLength);
+
+    private:
+        unsigned int stringOffset(std::string_view text);
+
+        const NameTable& m_Names;
+        std::vector<unsigned int> m_Nodes;
+        std::vector<unsigned int> m_Refs;
+        std::string m_Strings;
+        std::unordered_map<std::string_view, unsigned int> m_StringOffsets;   // Views into the tree's text and names
+        unsigned int m_NodeCount;
+        bool m_IsPositioned;
+};
+
+}
+
+unsigned int CacheWriter::stringOffset(std::string_view text) {
+    auto found = m_StringOffsets.find(text);
+    if (found != m_StringOffsets.end()) return found->second;
+    unsigned int offset = m_Strings.size();
+    unsigned int length = text.size();
+    m_Strings.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    m_Strings.append(text.data(), text.size());
+    m_Strings.append((4 - m_Strings.size() % 4) % 4, '\0');
+    m_StringOffsets.emplace(text, offset);
+    return offset;
+}
+
+// Depth first, a record is reserved before its children are written and filled in after.
+unsigned int CacheWriter::WriteNode(const ASTNode* node) {
+    if (node == nullptr) return ASTCache::NO_REF;
+    auto kind = node->GetKind();
+    auto& shape = NODE_SHAPES[kind];
+    unsigned int ref = m_Nodes.size();
+    m_Nodes.resize(ref + recordWords(kind), 0);
+    m_NodeCount++;
+    m_Nodes[ref] = kind | node->GetFlags() << 8;
+    m_Nodes[ref + 1] = m_IsPositioned ? node->GetPosition() : 0;
+    unsigned int word = ref + 2;
+    for (unsigned int i = 0; i < shape.children; i++) {
+        auto child = WriteNode(node->GetChild(i));
+        m_Nodes[word++] = child;
+    }
+    for (unsigned int i = 0; i < shape.lists; i++) {
+        auto list = node->GetList(i);
+        std::vector<unsigned int> items;
+        items.reserve(list.GetCount());
+        for (auto item : list) items.push_back(WriteNode(item));
+        m_Nodes[word++] = m_Refs.size();
+        m_Nodes[word++] = items.size();
+        m_Refs.insert(m_Refs.end(), items.begin(), items.end());
+    }
+    switch (shape.payload) {
+        case NP_NAMES:
+            for (unsigned int i = 0; i < shape.names; i++) m_Nodes[word++] = stringOffset(m_Names.GetName(node->GetName(i)));
+            break;
+        case NP_NAME_LIST:
+            {
+                auto names = node->GetNames();
+                m_Nodes[word++] = m_Refs.size();
+                m_Nodes[word++] = names.GetCount();
+                for (auto name : names) m_Refs.push_back(stringOffset(m_Names.GetName(name)));
+            }
+            break;
+        case NP_NUMBER:
+            {
+                auto value = node->GetNumber();
+                m_Nodes[word++] = value.isReal;
+                std::memcpy(&m_Nodes[word], &value.integer, sizeof(value.integer));
+            }
+            break;
+        case NP_TEXT:
+            m_Nodes[word++] = stringOffset(node->GetText());
+            break;
+        default:
+            break;
+    }
+    return ref;
+}
+
+bool CacheWriter::WriteFile(FILE* file, unsigned int root, unsigned long long sourceHash, unsigned long long sourceLength) {
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = ASTCache::VERSION;
+    header.headerSize = sizeof(CacheHeader);
+    header.sourceHash = sourceHash;
+    header.sourceLength = sourceLength;
+    header.nodesOffset = sizeof(CacheHeader);
+    header.nodesWords = m_Nodes.size();
+    header.refsOffset = header.nodesOffset + m_Nodes.size() * 4;
+    header.refsWords = m_Refs.size();
+    header.stringsOffset = header.refsOffset + m_Refs.size() * 4;
+    header.stringsBytes = m_Strings.size();
+    header.root = root;
+    header.nodeCount = m_NodeCount;
+    return fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(m_Nodes.data(), 4, m_Nodes.size(), file) == m_Nodes.size()
+        && fwrite(m_Refs.data(), 4, m_Refs.size(), file) == m_Refs.size()
+        && fwrite(m_Strings.data(), 1, m_Strings.size(), file) == m_Strings.size();
+}
+
+bool ASTCache::Write(const std::string& fileName, const ASTNode* root, const NameTable& names,
+                     unsigned long long sourceHash, unsigned long long sourceLength, bool isPositioned) {
+    CacheWriter writer(names, isPositioned);
+    auto rootRef = writer.WriteNode(root);
+
+    auto tempName = fileName + ".tmp" + std::to_string(getpid());
+    FILE* file = fopen(tempName.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool isWritten = writer.WriteFile(file, rootRef, sourceHash, sourceLength);
+    isWritten = fclose(file) == 0 && isWritten;
+    if (!isWritten || rename(tempName.c_str(), fileName.c_str()) != 0) {
+        unlink(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reading ////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+ASTCache::ASTCache() {
+    m_Map = nullptr; m_MapLength = 0; m_Nodes = nullptr; m_Refs = nullptr; m_Strings = nullptr;
+    m_NodesWords = 0; m_RefsWords = 0; m_StringsBytes = 0;
+}
+
+ASTCache::~ASTCache() {
+    if (m_Map != nullptr) munmap(const_cast<void*>(m_Map), m_MapLength);
+}
+
+std::shared_ptr<ASTCache> ASTCache::Open(const std::string& fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<size_t>(st.st_size) < sizeof(CacheHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t length = st.st_size;
+    void* map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return nullptr;
+
+    auto cache = std::shared_ptr<ASTCache>(new ASTCache());
+    cache->m_Map = map;
+    cache->m_MapLength = length;
+
+    auto header = static_cast<const CacheHeader*>(map);
+    auto fits = [length](unsigned long long offset, unsigned long long size) { return offset % 4 == 0 && offset + size <= length; };
+    if (std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header->version != VERSION
+        || header->headerSize != sizeof(CacheHeader)
+        || !fits(header->nodesOffset, header->nodesWords * 4ull) || !fits(header->refsOffset, header->refsWords * 4ull)
+        || !fits(header->stringsOffset, header->stringsBytes)) return nullptr;
+
+    auto base = static_cast<const char*>(map);
+    cache->m_Nodes = reinterpret_cast<const unsigned int*>(base + header->nodesOffset);
+    cache->m_Refs = reinterpret_cast<const unsigned int*>(base + header->refsOffset);
+    cache->m_Strings = base + header->stringsOffset;
+    cache->m_NodesWords = header->nodesWords;
+    cache->m_RefsWords = header->refsWords;
+    cache->m_StringsBytes = header->stringsBytes;
+    if (header->root != NO_REF && cache->GetRoot().IsNull()) return nullptr;
+    return cache;
+}
+
+bool ASTCache::Matches(unsigned long long sourceHash, unsigned long long sourceLength) const {
+    auto header = static_cast<const CacheHeader*>(m_Map);
+    return header->sourceHash == sourceHash && header->sourceLength == sourceLength;
+}
+
+unsigned long long ASTCache::GetSourceHash() const { return static_cast<const CacheHeader*>(m_Map)->sourceHash; }
+
+unsigned long long ASTCache::HashTree() const {
+    auto header = static_cast<const CacheHeader*>(m_Map);
+    unsigned long long hash = HashContent(m_Nodes, header->nodesWords * 4ull);
+    hash = HashContent(m_Refs, header->refsWords * 4ull, hash);
+    return HashContent(m_Strings, header->stringsBytes, hash);
+}
+
+unsigned int ASTCache::GetNodeCount() const { return static_cast<const CacheHeader*>(m_Map)->nodeCount; }
+
+ASTCacheNode ASTCache::GetRoot() const { return ASTCacheNode(this, static_cast<const CacheHeader*>(m_Map)->root); }
+
+ASTCacheNode::ASTCacheNode(const ASTCache* cache, unsigned int ref) {
+    m_Cache = cache;
+    m_Words = nullptr;
+    if (ref == ASTCache::NO_REF || ref + 2ull > cache->m_NodesWords) return;
+    auto kind = cache->m_Nodes[ref] & 0xFF;
+    if (kind >= N_KIND_COUNT || ref + static_cast<unsigned long long>(recordWords(static_cast<NodeKind>(kind))) > cache->m_NodesWords) return;
+    m_Words = cache->m_Nodes + ref;
+}
+
+unsigned int ASTCacheNode::GetNameCount() const {
+    auto& shape = NODE_SHAPES[GetKind()];
+    if (shape.payload == NP_NAME_LIST) return refsLength(payload());
+    return shape.payload == NP_NAMES ? shape.names : 0;
+}
+
+std::string_view ASTCacheNode::GetName(unsigned int index) const {
+    if (NODE_SHAPES[GetKind()].payload == NP_NAME_LIST) {
+        return index < refsLength(payload()) ? stringAt(m_Cache->m_Refs[payload()[0] + index]) : std::string_view();
+    }
+    return stringAt(payload()[index]);
+}
+
+NumberValue ASTCacheNode::GetNumber() const {
+    NumberValue value;
+    value.isReal = payload()[0] != 0;
+    std::memcpy(&value.integer, payload() + 1, sizeof(value.integer));
+    return value;
+}
+
+std::string_view ASTCacheNode::stringAt(unsigned int offset) const {
+    unsigned int length;
+    if (offset + static_cast<unsigned long long>(sizeof(length)) > m_Cache->m_StringsBytes) return std::string_view();
+    std::memcpy(&length, m_Cache->m_Strings + offset, sizeof(length));
+    if (offset + static_cast<unsigned long long>(sizeof(length)) + length > m_Cache->m_StringsBytes) return std::string_view();
+    return std::string_view(m_Cache->m_Strings + offset + sizeof(length), length);
+}
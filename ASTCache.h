@@ -0,0 +1,116 @@
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "ASTNode.h"
+#include "NameTable.h"
+
+#pragma once
+
+// On disk syntax tree of one source file, used as is through a read only mapping. There is no
+// loading pass: nodes are read in place through ASTCacheNode handles.
+//
+// Layout, all integers little endian and 4 byte aligned:
+//   Header      magic, version, hash and length of the source, section offsets and sizes
+//   Nodes       flat u32 array. A record is the ASTNode header word (kind | flags << 8), the
+//               position, one ref per child slot, (refs index, count) per list and the payload.
+//               Names and texts are string table offsets, a number is isReal and its 8 value bytes.
+//   Refs        u32 array, the items of node lists (node refs) and name lists (string offsets)
+//   Strings     u32 length followed by the bytes, padded to 4, every distinct string once
+// A node ref is the word index of the record in the Nodes section, NO_REF for a missing child.
+// Nothing in the file is an absolute address, so it can be mapped anywhere.
+//
+// Cache files are shared between builds and may be damaged, so every ref, list and string is
+// checked against its section where it is read. A node ref that is out of range or leads to a
+// record of an unknown kind or one that runs past the section reads as a missing node, a list or
+// name list that runs past the refs as empty, and a string that runs past the strings as empty.
+class ASTCacheNode;
+
+class ASTCache
+{
+    public:
+        static const unsigned int VERSION = 1;
+        static const unsigned int NO_REF = 0xFFFFFFFF;
+
+        // Maps a cache file. Returns nullptr if it can't be read, is not a cache of this version or
+        // its sections don't fit the file.
+        static std::shared_ptr<ASTCache> Open(const std::string& fileName);
+        // Serializes the tree under root with the hash and length of its source. names resolves the
+        // atoms in the tree. The file is written under a temporary name and renamed into place, so
+        // readers never see a partial cache. Without positions every node is written at position 0.
+        static bool Write(const std::string& fileName, const ASTNode* root, const NameTable& names,
+                          unsigned long long sourceHash, unsigned long long sourceLength, bool isPositioned = true);
+
+        ASTCache(const ASTCache&) = delete;
+        ASTCache& operator=(const ASTCache&) = delete;
+        ~ASTCache();
+
+        // True if the cache was made from a source with this content.
+        bool Matches(unsigned long long sourceHash, unsigned long long sourceLength) const;
+        unsigned long long GetSourceHash() const;
+        // Hash of the node, ref and string sections, the tree without the header. Equal trees
+        // written the same way hash the same.
+        unsigned long long HashTree() const;
+        unsigned int GetNodeCount() const;
+        // Null handle if the cached file was empty.
+        ASTCacheNode GetRoot() const;
+
+    private:
+        friend class ASTCacheNode;
+
+        ASTCache();
+
+        const void* m_Map;
+        size_t m_MapLength;
+        const unsigned int* m_Nodes;
+        const unsigned int* m_Refs;
+        const char* m_Strings;
+        unsigned int m_NodesWords;
+        unsigned int m_RefsWords;
+        unsigned int m_StringsBytes;
+};
+
+// Read only handle to a node in an ASTCache, the counterpart of ASTNode with names and texts
+// resolved to string views into the mapping. Copy it freely, it is two pointers.
+class ASTCacheNode
+{
+    public:
+        ASTCacheNode() { m_Cache = nullptr; m_Words = nullptr; }
+        ASTCacheNode(const ASTCache* cache, unsigned int ref);
+
+        bool IsNull() const { return m_Words == nullptr; }
+        NodeKind GetKind() const { return static_cast<NodeKind>(m_Words[0] & 0xFF); }
+        const char* GetKindName() const { return NODE_SHAPES[GetKind()].name; }
+        unsigned int GetPosition() const { return m_Words[1]; }
+        bool HasFlag(NodeFlag flag) const { return ((m_Words[0] >> 8) & flag) != 0; }
+        unsigned int GetFlags() const { return (m_Words[0] >> 8) & 0xFF; }
+
+        unsigned int GetChildCount() const { return NODE_SHAPES[GetKind()].children; }
+        ASTCacheNode GetChild(unsigned int index) const { return ASTCacheNode(m_Cache, m_Words[2 + index]); }
+        unsigned int GetListCount() const { return NODE_SHAPES[GetKind()].lists; }
+        unsigned int GetListLength(unsigned int list = 0) const { return refsLength(listWords(list)); }
+        ASTCacheNode GetListItem(unsigned int list, unsigned int index) const {
+            auto words = listWords(list);
+            return index < refsLength(words) ? ASTCacheNode(m_Cache, m_Cache->m_Refs[words[0] + index]) : ASTCacheNode();
+        }
+
+        // Names of an NP_NAMES or an NP_NAME_LIST payload.
+        unsigned int GetNameCount() const;
+        std::string_view GetName(unsigned int index = 0) const;
+        NumberValue GetNumber() const;
+        std::string_view GetText() const { return stringAt(payload()[0]); }
+
+    private:
+        const unsigned int* listWords(unsigned int list) const { return m_Words + 2 + GetChildCount() + list * 2; }
+        const unsigned int* payload() const { return listWords(GetListCount()); }
+        // Count of the (refs index, count) pair at words, 0 if it runs past the refs.
+        unsigned int refsLength(const unsigned int* words) const {
+            return static_cast<unsigned long long>(words[0]) + words[1] <= m_Cache->m_RefsWords ? words[1] : 0;
+        }
+        std::string_view stringAt(unsigned int offset) const;
+
+        const ASTCache* m_Cache;
+        const unsigned int* m_Words;
+};
@@ -1,393 +1,618 @@
+#include <cstring>
+#include <new>
+
 #include "ASTNode.h"
+#include "ASTShareTable.h"
+
+// Indexed by NodeKind: name, child slots, lists, payload, names.
+const NodeShape NODE_SHAPES[N_KIND_COUNT] = {
+    { "IdentDef",              0, 0, NP_NAMES,     1 },   // N_IDENT_DEF
+    { "Ident",                 0, 0, NP_NAMES,     1 },   // N_IDENT
+    { "Qualident",             0, 0, NP_NAMES,     2 },   // N_QUALIDENT
+    { "Assignment",            2, 0, NP_NONE,      0 },   // N_ASSIGNMENT
+    { "ProcedureCall",         2, 0, NP_NONE,      0 },   // N_PROCEDURE_CALL
+    { "Module",                2, 1, NP_NAMES,     1 },   // N_MODULE
+    { "DeclarationSequence",   0, 1, NP_NONE,      0 },   // N_DECLARATION_SEQUENCE
+    { "Definition",            2, 0, NP_NAMES,     1 },   // N_DEFINITION
+    { "ImportList",            0, 1, NP_NONE,      0 },   // N_IMPORT_LIST
+    { "ImportAssignPath",      1, 0, NP_NAMES,     3 },   // N_IMPORT_ASSIGN_PATH
+    { "ImportAssign",          1, 0, NP_NAMES,     2 },   // N_IMPORT_ASSIGN
+    { "ImportPath",            1, 0, NP_NAMES,     2 },   // N_IMPORT_PATH
+    { "Import",                1, 0, NP_NAMES,     1 },   // N_IMPORT
+    { "Less",                  2, 0, NP_NONE,      0 },   // N_LESS
+    { "LessEqual",             2, 0, NP_NONE,      0 },   // N_LESS_EQUAL
+    { "Equal",                 2, 0, NP_NONE,      0 },   // N_EQUAL
+    { "GreaterEqual",          2, 0, NP_NONE,      0 },   // N_GREATER_EQUAL
+    { "Greater",               2, 0, NP_NONE,      0 },   // N_GREATER
+    { "NotEqual",              2, 0, NP_NONE,      0 },   // N_NOT_EQUAL
+    { "In",                    2, 0, NP_NONE,      0 },   // N_IN
+    { "Is",                    2, 0, NP_NONE,      0 },   // N_IS
+    { "UnaryPlus",             1, 0, NP_NONE,      0 },   // N_UNARY_PLUS
+    { "UnaryMinus",            1, 0, NP_NONE,      0 },   // N_UNARY_MINUS
+    { "Plus",                  2, 0, NP_NONE,      0 },   // N_PLUS
+    { "Minus",                 2, 0, NP_NONE,      0 },   // N_MINUS
+    { "Or",                    2, 0, NP_NONE,      0 },   // N_OR
+    { "Mul",                   2, 0, NP_NONE,      0 },   // N_MUL
+    { "Slash",                 2, 0, NP_NONE,      0 },   // N_SLASH
+    { "Div",                   2, 0, NP_NONE,      0 },   // N_DIV
+    { "Mod",                   2, 0, NP_NONE,      0 },   // N_MOD
+    { "And",                   2, 0, NP_NONE,      0 },   // N_AND
+    { "Number",                0, 0, NP_NUMBER,    0 },   // N_NUMBER
+    { "String",                0, 0, NP_TEXT,      0 },   // N_STRING
+    { "HexString",             0, 0, NP_TEXT,      0 },   // N_HEX_STRING
+    { "HexChar",               0, 0, NP_NUMBER,    0 },   // N_HEX_CHAR
+    { "Nil",                   0, 0, NP_NONE,      0 },   // N_NIL
+    { "True",                  0, 0, NP_NONE,      0 },   // N_TRUE
+    { "False",                 0, 0, NP_NONE,      0 },   // N_FALSE
+    { "Call",                  2, 0, NP_NONE,      0 },   // N_CALL
+    { "BitInvert",             1, 0, NP_NONE,      0 },   // N_BIT_INVERT
+    { "ExpressionList",        0, 1, NP_NONE,      0 },   // N_EXPRESSION_LIST
+    { "StatementSequence",     0, 1, NP_NONE,      0 },   // N_STATEMENT_SEQUENCE
+    { "If",                    3, 1, NP_NONE,      0 },   // N_IF
+    { "Elsif",                 2, 0, NP_NONE,      0 },   // N_ELSIF
+    { "Else",                  1, 0, NP_NONE,      0 },   // N_ELSE
+    { "While",                 2, 1, NP_NONE,      0 },   // N_WHILE
+    { "CaseStatement",         2, 1, NP_NONE,      0 },   // N_CASE_STATEMENT
+    { "Case",                  2, 0, NP_NONE,      0 },   // N_CASE
+    { "CaseLabelList",         0, 1, NP_NONE,      0 },   // N_CASE_LABEL_LIST
+    { "LabelRange",            2, 0, NP_NONE,      0 },   // N_LABEL_RANGE
+    { "Repeat",                2, 0, NP_NONE,      0 },   // N_REPEAT
+    { "For",                   4, 0, NP_NAMES,     1 },   // N_FOR
+    { "With",                  1, 2, NP_NONE,      0 },   // N_WITH
+    { "Guard",                 2, 0, NP_NONE,      0 },   // N_GUARD
+    { "Loop",                  1, 0, NP_NONE,      0 },   // N_LOOP
+    { "Exit",                  0, 0, NP_NONE,      0 },   // N_EXIT
+    { "Return",                1, 0, NP_NONE,      0 },   // N_RETURN
+    { "FormalParameters",      0, 1, NP_NONE,      0 },   // N_FORMAL_PARAMETERS
+    { "FPSection",             1, 0, NP_NAME_LIST, 0 },   // N_FP_SECTION
+    { "Reciver",               0, 0, NP_NAMES,     2 },   // N_RECIVER
+    { "ProcedureHeading",      3, 0, NP_NONE,      0 },   // N_PROCEDURE_HEADING
+    { "ProcedureDeclaration",  2, 0, NP_NAMES,     1 },   // N_PROCEDURE_DECLARATION
+    { "ProcedureBody",         2, 0, NP_NONE,      0 },   // N_PROCEDURE_BODY
+    { "Set",                   0, 1, NP_NONE,      0 },   // N_SET
+    { "Element",               2, 0, NP_NONE,      0 },   // N_ELEMENT
+    { "ActualParameters",      1, 0, NP_NONE,      0 },   // N_ACTUAL_PARAMETERS
+    { "Designator",            1, 1, NP_NONE,      0 },   // N_DESIGNATOR
+    { "DotName",               0, 0, NP_NAMES,     1 },   // N_DOT_NAME
+    { "CallQualident",         1, 0, NP_NONE,      0 },   // N_CALL_QUALIDENT
+    { "Index",                 1, 0, NP_NONE,      0 },   // N_INDEX
+    { "Arrow",                 0, 0, NP_NONE,      0 },   // N_ARROW
+    { "Enumeration",           0, 0, NP_NAME_LIST, 0 },   // N_ENUMERATION
+    { "ArrayOf",               2, 0, NP_NONE,      0 },   // N_ARRAY_OF
+    { "Array",                 2, 0, NP_NONE,      0 },   // N_ARRAY
+    { "LengthList",            0, 1, NP_NONE,      0 },   // N_LENGTH_LIST
+    { "TypeParams",            0, 0, NP_NAME_LIST, 0 },   // N_TYPE_PARAMS
+    { "TypeActuals",           0, 1, NP_NONE,      0 },   // N_TYPE_ACTUALS
+    { "RecordType",            2, 0, NP_NONE,      0 },   // N_RECORD_TYPE
+    { "FieldListSequence",     0, 1, NP_NONE,      0 },   // N_FIELD_LIST_SEQUENCE
+    { "FieldList",             2, 0, NP_NONE,      0 },   // N_FIELD_LIST
+    { "IdentList",             0, 1, NP_NONE,      0 },   // N_IDENT_LIST
+    { "Pointer",               1, 0, NP_NONE,      0 },   // N_POINTER
+    { "ProcedureType",         1, 0, NP_NONE,      0 },   // N_PROCEDURE_TYPE
+    { "VariableDeclaration",   2, 0, NP_NONE,      0 },   // N_VARIABLE_DECLARATION
+    { "ConstDeclaration",      2, 0, NP_NONE,      0 },   // N_CONST_DECLARATION
+    { "TypeDeclaration",       2, 0, NP_NONE,      0 },   // N_TYPE_DECLARATION
+};
+
+static_assert(sizeof(ASTNode) == 8, "The node header must stay 8 bytes");
+
+static thread_local size_t s_Created = 0;
+
+ASTNode::ASTNode(NodeKind kind, unsigned int pos, unsigned int flags) {
+    m_Kind = static_cast<unsigned char>(kind);
+    m_Flags = static_cast<unsigned char>(flags);
+    m_Marks = 0;
+    m_Pos = pos;
+    s_Created++;
+}
+
+size_t ASTNode::GetCreatedCount() { return s_Created; }
+
+size_t ASTNode::GetSize(NodeKind kind) {
+    auto& shape = NODE_SHAPES[kind];
+    size_t size = sizeof(ASTNode) + shape.children * sizeof(ASTNode*) + shape.lists * sizeof(ASTNodeList);
+    switch (shape.payload) {
+        case NP_NAMES:      size += shape.names * sizeof(Atom); break;
+        case NP_NAME_LIST:  size += sizeof(AtomList); break;
+        case NP_NUMBER:     size += sizeof(NumberValue); break;
+        case NP_TEXT:       size += sizeof(std::string_view); break;
+        default:            break;
+    }
+    return (size + alignof(ASTNode*) - 1) & ~(alignof(ASTNode*) - 1);
+}
+
+std::string ASTNode::DecodeText() const {
+    auto text = GetText();
+    if (GetKind() != N_HEX_STRING) return std::string(text);
+    std::string bytes;
+    bytes.reserve(text.size() / 2);
+    int high = -1;
+    for (char c : text) {
+        int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (digit < 0) continue;    // Whitespace between the pairs
+        if (high < 0) high = digit;
+        else {
+            bytes.push_back(static_cast<char>(high * 16 + digit));
+            high = -1;
+        }
+    }
+    return bytes;
+}
+
+// Allocates a node of kind with every child slot, list and payload zeroed.
+ASTNode* ASTNode::make(ASTArena& arena, NodeKind kind, unsigned int pos, unsigned int flags) {
+    size_t size = GetSize(kind);
+    void* memory = arena.Allocate(size, alignof(ASTNode*));
+    std::memset(memory, 0, size);
+    return new (memory) ASTNode(kind, pos, flags);
+}
+
+ASTNode* ASTNode::make(ASTArena& arena, NodeKind kind, unsigned int pos, ASTNode* child) {
+    auto node = make(arena, kind, pos);
+    node->children()[0] = child;
+    return node;
+}
+
+ASTNode* ASTNode::make(ASTArena& arena, NodeKind kind, unsigned int pos, ASTNode* left, ASTNode* right) {
+    auto node = make(arena, kind, pos);
+    node->children()[0] = left;
+    node->children()[1] = right;
+    return node;
+}
+
+// With a share table on the arena an equal node made before is given back, the new one is then
+// still the last allocation and goes back to the arena.
+ASTNode* ASTNode::share(ASTArena& arena, ASTNode* node) {
+    auto table = arena.GetShareTable();
+    if (table == nullptr) return node;
+    auto shared = table->Intern(node);
+    if (shared != node) arena.Release(node, GetSize(node->GetKind()));
+    return shared;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Make functions /////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+ASTNode* ASTNode::MakeIdentDefNode(ASTArena& arena, unsigned int pos, Atom name, bool isreadOnlyExport, bool isExport) {
+    auto node = make(arena, N_IDENT_DEF, pos, (isreadOnlyExport ? NF_READ_ONLY : 0) | (isExport ? NF_EXPORT : 0));
+    node->setName(0, name);
+    return node;
+}
 
-ASTNode::ASTNode(unsigned int line, unsigned col) {
-    m_Line = line; m_Col = col;
+ASTNode* ASTNode::MakeIdentNode(ASTArena& arena, unsigned int pos, Atom name) {
+    auto node = make(arena, N_IDENT, pos);
+    node->setName(0, name);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeIdentDefNode(unsigned int line, unsigned int col, std::string text, bool isreadOnlyExport, bool isExport) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeQualidentNode(ASTArena& arena, unsigned int pos, Atom name1, Atom name2) {
+    auto node = make(arena, N_QUALIDENT, pos);
+    node->setName(0, name1);
+    node->setName(1, name2);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeIdentNode(unsigned int line, unsigned int col, std::string text) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeAssignmentNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_ASSIGNMENT, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeQualidentNode(unsigned int line, unsigned int col, std::string text1, std::string text2) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeProcedureCallNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_PROCEDURE_CALL, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeAssignmentNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeModuleNode(ASTArena& arena, unsigned int pos, Atom moduleName, ASTNode* left, ASTNodeList nodes, ASTNode* right) {
+    auto node = make(arena, N_MODULE, pos, left, right);
+    node->lists()[0] = nodes;
+    node->setName(0, moduleName);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeProcedureCallNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeDeclarationSequence2Node(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_DECLARATION_SEQUENCE, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeModuleNode(
-                    unsigned int line, 
-                    unsigned int col, 
-                    std::string moduleText, std::shared_ptr<ASTNode> left, 
-                    std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes, 
-                    std::shared_ptr<ASTNode> right) {
-                        return std::make_shared<ASTNode>(line, col);
-                    }
+ASTNode* ASTNode::MakeDeclarationNode(ASTArena& arena, unsigned int pos, Atom name, ASTNode* left, ASTNode* right) {
+    auto node = make(arena, N_DEFINITION, pos, left, right);
+    node->setName(0, name);
+    return node;
+}
 
-std::shared_ptr<ASTNode> ASTNode::MakeDeclarationSequence2Node(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);   
+ASTNode* ASTNode::MakeImportListNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_IMPORT_LIST, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeDeclarationNode(unsigned int line, unsigned int col, std::string name, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);   
+ASTNode* ASTNode::MakeImportAssignPathNode(ASTArena& arena, unsigned int pos, Atom left, Atom right, Atom next, ASTNode* last) {
+    auto node = make(arena, N_IMPORT_ASSIGN_PATH, pos, last);
+    node->setName(0, left);
+    node->setName(1, right);
+    node->setName(2, next);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeImportListNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col); 
+ASTNode* ASTNode::MakeImportAssignNode(ASTArena& arena, unsigned int pos, Atom left, Atom right, ASTNode* next) {
+    auto node = make(arena, N_IMPORT_ASSIGN, pos, next);
+    node->setName(0, left);
+    node->setName(1, right);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeImportAssignPathNode(unsigned int line, unsigned int col, std::string left, std::string right, std::string next, std::shared_ptr<ASTNode> last) {
-    return std::make_shared<ASTNode>(line, col); 
+ASTNode* ASTNode::MakeImportPathNode(ASTArena& arena, unsigned int pos, Atom left, Atom right, ASTNode* next) {
+    auto node = make(arena, N_IMPORT_PATH, pos, next);
+    node->setName(0, left);
+    node->setName(1, right);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeImportAssignNode(unsigned int line, unsigned int col, std::string left, std::string right, std::shared_ptr<ASTNode> next) {
-    return std::make_shared<ASTNode>(line, col); 
+ASTNode* ASTNode::MakeImportNode(ASTArena& arena, unsigned int pos, Atom left, ASTNode* right) {
+    auto node = make(arena, N_IMPORT, pos, right);
+    node->setName(0, left);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeImportPathNode(unsigned int line, unsigned int col, std::string left, std::string right, std::shared_ptr<ASTNode> next) {
-    return std::make_shared<ASTNode>(line, col); 
+ASTNode* ASTNode::MakeLessCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_LESS, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeImportNode(unsigned int line, unsigned int col, std::string left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col); 
+ASTNode* ASTNode::MakeLessEqualCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_LESS_EQUAL, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLessCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeEqualCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_EQUAL, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLessEqualCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeGreaterEqualCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_GREATER_EQUAL, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeEqualCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeGreaterCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_GREATER, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeGreaterEqualCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeNotEqualCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_NOT_EQUAL, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeGreaterCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeInCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_IN, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeNotEqualCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeIsCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_IS, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeInCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeUnaryPlusNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return share(arena, make(arena, N_UNARY_PLUS, pos, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeIsCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeUnaryMinusNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return share(arena, make(arena, N_UNARY_MINUS, pos, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeUnaryPlusNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakePlusNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_PLUS, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeUnaryMinusNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeMinusNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_MINUS, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakePlusNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeOrNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_OR, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeMinusNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeMulNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_MUL, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeOrNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeSlashNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_SLASH, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeMulNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeDivNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_DIV, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeSlashNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeModNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_MOD, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeDivNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeAndNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_AND, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeModNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLiteralNumberNode(ASTArena& arena, unsigned int pos, NumberValue value) {
+    auto node = make(arena, N_NUMBER, pos);
+    *static_cast<NumberValue*>(node->payload()) = value;
+    return share(arena, node);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeAndNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLiteralStringNode(ASTArena& arena, unsigned int pos, std::string_view text) {
+    auto node = make(arena, N_STRING, pos);
+    *static_cast<std::string_view*>(node->payload()) = text;
+    return share(arena, node);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLiteralNumberNode(unsigned int line, unsigned int col, std::string text) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLiteralHexStringNode(ASTArena& arena, unsigned int pos, std::string_view text) {
+    auto node = make(arena, N_HEX_STRING, pos);
+    *static_cast<std::string_view*>(node->payload()) = text;
+    return share(arena, node);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLiteralStringNode(unsigned int line, unsigned int col, std::string text) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLiteralHexCharNode(ASTArena& arena, unsigned int pos, NumberValue value) {
+    auto node = make(arena, N_HEX_CHAR, pos);
+    *static_cast<NumberValue*>(node->payload()) = value;
+    return share(arena, node);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLiteralHexStringNode(unsigned int line, unsigned int col, std::string text) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLiteralNilNode(ASTArena& arena, unsigned int pos) {
+    return share(arena, make(arena, N_NIL, pos));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLiteralHexCharNode(unsigned int line, unsigned int col, std::string text) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLiteralTrueNode(ASTArena& arena, unsigned int pos) {
+    return share(arena, make(arena, N_TRUE, pos));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLiteralNilNode(unsigned int line, unsigned int col) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLiteralFalseNode(ASTArena& arena, unsigned int pos) {
+    return share(arena, make(arena, N_FALSE, pos));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLiteralTrueNode(unsigned int line, unsigned int col) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeCallNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_CALL, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLiteralFalseNode(unsigned int line, unsigned int col) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeBitInvertNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return share(arena, make(arena, N_BIT_INVERT, pos, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeCallNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeBinaryNode(ASTArena& arena, NodeKind kind, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, kind, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeBitInvertNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeUnaryNode(ASTArena& arena, NodeKind kind, unsigned int pos, ASTNode* right) {
+    return share(arena, make(arena, kind, pos, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeExpressionListNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeExpressionListNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_EXPRESSION_LIST, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeStatementSequenceNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeStatementSequenceNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_STATEMENT_SEQUENCE, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeIfStatementNode(
-                                        unsigned int line, 
-                                        unsigned int col, 
-                                        std::shared_ptr<ASTNode> left, 
-                                        std::shared_ptr<ASTNode> right, 
-                                        std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes,
-                                        std::shared_ptr<ASTNode> next) {
-                                                return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeIfStatementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right, ASTNodeList nodes, ASTNode* next) {
+    auto node = make(arena, N_IF, pos, left, right);
+    node->children()[2] = next;
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeElsifStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-     return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeElsifStatementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_ELSIF, pos, left, right);
 }
-std::shared_ptr<ASTNode> ASTNode::MakeElseStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-     return std::make_shared<ASTNode>(line, col);
+
+ASTNode* ASTNode::MakeElseStatementNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return make(arena, N_ELSE, pos, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeWhileStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col, 
-                                            std::shared_ptr<ASTNode> left, 
-                                            std::shared_ptr<ASTNode> right, 
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-                                                return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeWhileStatementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right, ASTNodeList nodes) {
+    auto node = make(arena, N_WHILE, pos, left, right);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeCaseStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col, 
-                                            std::shared_ptr<ASTNode> left, 
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes, 
-                                            std::shared_ptr<ASTNode> right) {
-                                                return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeCaseStatementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNodeList nodes, ASTNode* right) {
+    auto node = make(arena, N_CASE_STATEMENT, pos, left, right);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeCaseStatement(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeCaseStatement(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_CASE, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeCaseLabelRangeNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeCaseLabelRangeNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_CASE_LABEL_LIST, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLabelRangeNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLabelRangeNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_LABEL_RANGE, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeRepeatStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeRepeatStatementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_REPEAT, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeForStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col,
-                                            std::string literalText,
-                                            std::shared_ptr<ASTNode> left, 
-                                            std::shared_ptr<ASTNode> right,
-                                            std::shared_ptr<ASTNode> next,
-                                            std::shared_ptr<ASTNode> seq) {
-                                                return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeForStatementNode(ASTArena& arena, unsigned int pos, Atom name, ASTNode* left, ASTNode* right, ASTNode* next, ASTNode* seq) {
+    auto node = make(arena, N_FOR, pos, left, right);
+    node->children()[2] = next;
+    node->children()[3] = seq;
+    node->setName(0, name);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::WithStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col,
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> GuardNodes,
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> StatementBlockNodes,
-                                            std::shared_ptr<ASTNode> elsePart) {
-                                                return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::WithStatementNode(ASTArena& arena, unsigned int pos, ASTNodeList GuardNodes, ASTNodeList StatementBlockNodes, ASTNode* elsePart) {
+    auto node = make(arena, N_WITH, pos, elsePart);
+    node->lists()[0] = GuardNodes;
+    node->lists()[1] = StatementBlockNodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::GuardNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::GuardNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_GUARD, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLoopStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLoopStatementNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return make(arena, N_LOOP, pos, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeExitStatementNode(unsigned int line, unsigned int col) {
-    return std::make_shared<ASTNode>(line, col);   
+ASTNode* ASTNode::MakeExitStatementNode(ASTArena& arena, unsigned int pos) {
+    return make(arena, N_EXIT, pos);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeReturnStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col); 
+ASTNode* ASTNode::MakeReturnStatementNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return make(arena, N_RETURN, pos, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeFormalParametersNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeFormalParametersNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_FORMAL_PARAMETERS, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeFPSectionNode(
-                                            unsigned int line, 
-                                            unsigned int col, 
-                                            std::shared_ptr<std::vector<std::string>> nodes,
-                                            std::shared_ptr<ASTNode> right,
-                                            bool isVar,
-                                            bool isIn) {
-                                                return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeFPSectionNode(ASTArena& arena, unsigned int pos, AtomList names, ASTNode* right, bool isVar, bool isIn) {
+    auto node = make(arena, N_FP_SECTION, pos, right);
+    node->m_Flags = (isVar ? NF_VAR : 0) | (isIn ? NF_IN : 0);
+    *static_cast<AtomList*>(node->payload()) = names;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeReciverNode(unsigned int line, unsigned int col, std::string left, std::string right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeReciverNode(ASTArena& arena, unsigned int pos, Atom left, Atom right, bool isVar, bool isIn) {
+    auto node = make(arena, N_RECIVER, pos, (isVar ? NF_VAR : 0) | (isIn ? NF_IN : 0));
+    node->setName(0, left);
+    node->setName(1, right);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeProcedureHeading(
-                                            unsigned int line, 
-                                            unsigned int col, 
-                                            bool isProc, 
-                                            std::shared_ptr<ASTNode> reciver, 
-                                            std::shared_ptr<ASTNode> name, 
-                                            std::shared_ptr<ASTNode> parameters) {
-                                                return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeProcedureHeading(ASTArena& arena, unsigned int pos, bool isProc, ASTNode* reciver, ASTNode* name, ASTNode* parameters) {
+    auto node = make(arena, N_PROCEDURE_HEADING, pos, reciver, name);
+    node->children()[2] = parameters;
+    node->m_Flags = isProc ? NF_PROC : 0;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeProcedureDeclarationNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right, std::string name) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeProcedureDeclarationNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right, Atom name) {
+    auto node = make(arena, N_PROCEDURE_DECLARATION, pos, left, right);
+    node->setName(0, name);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeProcedureBodyNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeProcedureBodyNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_PROCEDURE_BODY, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeSetNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeSetNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_SET, pos);
+    node->lists()[0] = nodes;
+    return share(arena, node);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeElementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeElementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return share(arena, make(arena, N_ELEMENT, pos, left, right));
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeActualParametersNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeActualParametersNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return make(arena, N_ACTUAL_PARAMETERS, pos, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeDesignatorNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeDesignatorNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNodeList nodes) {
+    auto node = make(arena, N_DESIGNATOR, pos, left);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeDotNameNode(unsigned int line, unsigned int col, std::string text) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeDotNameNode(ASTArena& arena, unsigned int pos, Atom name) {
+    auto node = make(arena, N_DOT_NAME, pos);
+    node->setName(0, name);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeCallQualidentNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeCallQualidentNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return make(arena, N_CALL_QUALIDENT, pos, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeIndexNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeIndexNode(ASTArena& arena, unsigned int pos, ASTNode* right) {
+    return make(arena, N_INDEX, pos, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeArrowNode(unsigned int line, unsigned int col) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeArrowNode(ASTArena& arena, unsigned int pos) {
+    return make(arena, N_ARROW, pos);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeEnumerationNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::string>> nodes) {
-    return std::make_shared<ASTNode>(line, col);   
+ASTNode* ASTNode::MakeEnumerationNode(ASTArena& arena, unsigned int pos, AtomList names) {
+    auto node = make(arena, N_ENUMERATION, pos);
+    *static_cast<AtomList*>(node->payload()) = names;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeArrayOfNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col); 
+ASTNode* ASTNode::MakeArrayOfNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_ARRAY_OF, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeArrayNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col); 
+ASTNode* ASTNode::MakeArrayNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_ARRAY, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeLengthList(unsigned int line, unsigned int col, bool isVar, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeLengthList(ASTArena& arena, unsigned int pos, bool isVar, ASTNodeList nodes) {
+    auto node = make(arena, N_LENGTH_LIST, pos, isVar ? NF_VAR : 0);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeTypeParamsNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::string>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeTypeParamsNode(ASTArena& arena, unsigned int pos, AtomList names) {
+    auto node = make(arena, N_TYPE_PARAMS, pos);
+    *static_cast<AtomList*>(node->payload()) = names;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeTypeActualsNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeTypeActualsNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_TYPE_ACTUALS, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeRecordTypeNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeRecordTypeNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_RECORD_TYPE, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeFieldListSequenceNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeFieldListSequenceNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_FIELD_LIST_SEQUENCE, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeFieldListNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);   
+ASTNode* ASTNode::MakeFieldListNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_FIELD_LIST, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeIdentListNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeIdentListNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes) {
+    auto node = make(arena, N_IDENT_LIST, pos);
+    node->lists()[0] = nodes;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakePointerNode(unsigned int line, unsigned int col, bool isArrow, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakePointerNode(ASTArena& arena, unsigned int pos, bool isArrow, ASTNode* right) {
+    auto node = make(arena, N_POINTER, pos, right);
+    node->m_Flags = isArrow ? NF_ARROW : 0;
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeProcedureTypeNode(unsigned int line, unsigned int col, bool isProc, bool isPointer, bool isArrow, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeProcedureTypeNode(ASTArena& arena, unsigned int pos, bool isProc, bool isPointer, bool isArrow, ASTNode* right) {
+    auto node = make(arena, N_PROCEDURE_TYPE, pos, right);
+    node->m_Flags = (isProc ? NF_PROC : 0) | (isPointer ? NF_POINTER : 0) | (isArrow ? NF_ARROW : 0);
+    return node;
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeVariableDeclarationNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeVariableDeclarationNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_VARIABLE_DECLARATION, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeConstDeclarationNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
+ASTNode* ASTNode::MakeConstDeclarationNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_CONST_DECLARATION, pos, left, right);
 }
 
-std::shared_ptr<ASTNode> ASTNode::MakeTypeDeclarationNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right) {
-    return std::make_shared<ASTNode>(line, col);
-}
\ No newline at end of file
+ASTNode* ASTNode::MakeTypeDeclarationNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right) {
+    return make(arena, N_TYPE_DECLARATION, pos, left, right);
+}
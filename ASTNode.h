@@ -1,150 +1,242 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "ASTArena.h"
+#include "NameTable.h"
+#include "Tokenizer.h"
+
 
 #pragma once
 
+class ASTNode;
+
+typedef ASTList<ASTNode*> ASTNodeList;
+typedef ASTList<Atom> AtomList;
+
+// One kind per Make function below.
+typedef enum {
+    N_IDENT_DEF, N_IDENT, N_QUALIDENT, N_ASSIGNMENT, N_PROCEDURE_CALL, N_MODULE, N_DECLARATION_SEQUENCE, N_DEFINITION,
+    N_IMPORT_LIST, N_IMPORT_ASSIGN_PATH, N_IMPORT_ASSIGN, N_IMPORT_PATH, N_IMPORT,
+    N_LESS, N_LESS_EQUAL, N_EQUAL, N_GREATER_EQUAL, N_GREATER, N_NOT_EQUAL, N_IN, N_IS,
+    N_UNARY_PLUS, N_UNARY_MINUS, N_PLUS, N_MINUS, N_OR, N_MUL, N_SLASH, N_DIV, N_MOD, N_AND,
+    N_NUMBER, N_STRING, N_HEX_STRING, N_HEX_CHAR, N_NIL, N_TRUE, N_FALSE, N_CALL, N_BIT_INVERT, N_EXPRESSION_LIST,
+    N_STATEMENT_SEQUENCE, N_IF, N_ELSIF, N_ELSE, N_WHILE, N_CASE_STATEMENT, N_CASE, N_CASE_LABEL_LIST, N_LABEL_RANGE,
+    N_REPEAT, N_FOR, N_WITH, N_GUARD, N_LOOP, N_EXIT, N_RETURN, N_FORMAL_PARAMETERS, N_FP_SECTION, N_RECIVER,
+    N_PROCEDURE_HEADING, N_PROCEDURE_DECLARATION, N_PROCEDURE_BODY, N_SET, N_ELEMENT, N_ACTUAL_PARAMETERS,
+    N_DESIGNATOR, N_DOT_NAME, N_CALL_QUALIDENT, N_INDEX, N_ARROW, N_ENUMERATION, N_ARRAY_OF, N_ARRAY, N_LENGTH_LIST,
+    N_TYPE_PARAMS, N_TYPE_ACTUALS, N_RECORD_TYPE, N_FIELD_LIST_SEQUENCE, N_FIELD_LIST, N_IDENT_LIST, N_POINTER,
+    N_PROCEDURE_TYPE, N_VARIABLE_DECLARATION, N_CONST_DECLARATION, N_TYPE_DECLARATION,
+    N_KIND_COUNT
+} NodeKind;
+
+typedef enum {
+    NF_EXPORT = 1, NF_READ_ONLY = 2, NF_VAR = 4, NF_IN = 8, NF_PROC = 16, NF_POINTER = 32, NF_ARROW = 64
+} NodeFlag;
+
+typedef enum { NP_NONE, NP_NAMES, NP_NAME_LIST, NP_NUMBER, NP_TEXT } NodePayload;
+
+// Fixed layout of a node kind: how many child slots and lists it has and what payload follows them.
+struct NodeShape {
+    const char* name;
+    unsigned char children;
+    unsigned char lists;
+    unsigned char payload;
+    unsigned char names;    // Atoms in an NP_NAMES payload
+};
+
+extern const NodeShape NODE_SHAPES[N_KIND_COUNT];
+
+// Tagged syntax tree node. An 8 byte header is followed in the same allocation by the child slots,
+// then the lists (pointer and count into a side array), then the payload of the kind, so a binary
+// operator is 24 bytes and the whole node usually shares one cache line with its children's slots.
+// The layout is looked up in NODE_SHAPES, there are no virtual functions.
+// Nodes are allocated in an ASTArena by the Make functions and are never deleted on their own.
+// Literal text is a view into the SourceBuffer, or the NameTable when the source is streamed or the
+// TokenStream interns strings, the Parser keeps both alive in the arena.
 class ASTNode
 {
     public:
-        ASTNode(unsigned int line, unsigned col);
-
-
-        static std::shared_ptr<ASTNode> MakeIdentDefNode(unsigned int line, unsigned int col, std::string text, bool isreadOnlyExport, bool isExport);
-        static std::shared_ptr<ASTNode> MakeIdentNode(unsigned int line, unsigned int col, std::string text);
-        static std::shared_ptr<ASTNode> MakeQualidentNode(unsigned int line, unsigned int col, std::string text1, std::string text2);
-        static std::shared_ptr<ASTNode> MakeAssignmentNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeProcedureCallNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeModuleNode(
-                    unsigned int line, 
-                    unsigned int col, 
-                    std::string moduleText, std::shared_ptr<ASTNode> left, 
-                    std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes, 
-                    std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeDeclarationSequence2Node(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeDeclarationNode(unsigned int line, unsigned int col, std::string name, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeImportListNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeImportAssignPathNode(unsigned int line, unsigned int col, std::string left, std::string right, std::string next, std::shared_ptr<ASTNode> last);
-        static std::shared_ptr<ASTNode> MakeImportAssignNode(unsigned int line, unsigned int col, std::string left, std::string right, std::shared_ptr<ASTNode> next);
-        static std::shared_ptr<ASTNode> MakeImportPathNode(unsigned int line, unsigned int col, std::string left, std::string right, std::shared_ptr<ASTNode> next);
-        static std::shared_ptr<ASTNode> MakeImportNode(unsigned int line, unsigned int col, std::string left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeLessCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeLessEqualCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeEqualCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeGreaterEqualCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeGreaterCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeNotEqualCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeInCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeIsCompareNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeUnaryPlusNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeUnaryMinusNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakePlusNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeMinusNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeOrNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeMulNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeSlashNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeDivNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeModNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeAndNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeLiteralNumberNode(unsigned int line, unsigned int col, std::string text);
-        static std::shared_ptr<ASTNode> MakeLiteralStringNode(unsigned int line, unsigned int col, std::string text);
-        static std::shared_ptr<ASTNode> MakeLiteralHexStringNode(unsigned int line, unsigned int col, std::string text);
-        static std::shared_ptr<ASTNode> MakeLiteralHexCharNode(unsigned int line, unsigned int col, std::string text);
-        static std::shared_ptr<ASTNode> MakeLiteralNilNode(unsigned int line, unsigned int col);
-        static std::shared_ptr<ASTNode> MakeLiteralTrueNode(unsigned int line, unsigned int col);
-        static std::shared_ptr<ASTNode> MakeLiteralFalseNode(unsigned int line, unsigned int col);
-        static std::shared_ptr<ASTNode> MakeCallNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeBitInvertNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeExpressionListNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeStatementSequenceNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeIfStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col, 
-                                            std::shared_ptr<ASTNode> left, 
-                                            std::shared_ptr<ASTNode> right, 
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes,
-                                            std::shared_ptr<ASTNode> next);
-        static std::shared_ptr<ASTNode> MakeElsifStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeElseStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeWhileStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col, 
-                                            std::shared_ptr<ASTNode> left, 
-                                            std::shared_ptr<ASTNode> right, 
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeCaseStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col, 
-                                            std::shared_ptr<ASTNode> left, 
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes, 
-                                            std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeCaseStatement(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeCaseLabelRangeNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeLabelRangeNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeRepeatStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeForStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col,
-                                            std::string literalText,
-                                            std::shared_ptr<ASTNode> left,
-                                            std::shared_ptr<ASTNode> right,
-                                            std::shared_ptr<ASTNode> next,
-                                            std::shared_ptr<ASTNode> seq);
-        static std::shared_ptr<ASTNode> WithStatementNode(
-                                            unsigned int line, 
-                                            unsigned int col,
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> GuardNodes,
-                                            std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> StatementBlockNodes,
-                                            std::shared_ptr<ASTNode> elsePart);
-        static std::shared_ptr<ASTNode> GuardNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeLoopStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeExitStatementNode(unsigned int line, unsigned int col);
-        static std::shared_ptr<ASTNode> MakeReturnStatementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeFormalParametersNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeFPSectionNode(
-                                            unsigned int line, 
-                                            unsigned int col, 
-                                            std::shared_ptr<std::vector<std::string>> nodes,
-                                            std::shared_ptr<ASTNode> right,
+        NodeKind GetKind() const { return static_cast<NodeKind>(m_Kind); }
+        const char* GetKindName() const { return NODE_SHAPES[m_Kind].name; }
+        // Byte offset of the node's first token, SourceBuffer::GetLines() maps it to line and column.
+        unsigned int GetPosition() const { return m_Pos; }
+        bool HasFlag(NodeFlag flag) const { return (m_Flags & flag) != 0; }
+        unsigned int GetFlags() const { return m_Flags; }
+        // Made with an ASTShareTable and possibly used in several places of the tree, see there.
+        bool IsShared() const { return (m_Marks & MARK_SHARED) != 0; }
+
+        // Optional children are nullptr, the slot order is the argument order of the Make function.
+        unsigned int GetChildCount() const { return NODE_SHAPES[m_Kind].children; }
+        ASTNode* GetChild(unsigned int index) const { return children()[index]; }
+        unsigned int GetListCount() const { return NODE_SHAPES[m_Kind].lists; }
+        ASTNodeList GetList(unsigned int index = 0) const { return lists()[index]; }
+
+        // Payload, only valid for the kinds that carry it.
+        Atom GetName(unsigned int index = 0) const { return reinterpret_cast<const Atom*>(payload())[index]; }
+        AtomList GetNames() const { return *reinterpret_cast<const AtomList*>(payload()); }
+        NumberValue GetNumber() const { return *reinterpret_cast<const NumberValue*>(payload()); }
+        // Literal text as written, a view into the source or the NameTable, never a copy.
+        std::string_view GetText() const { return *reinterpret_cast<const std::string_view*>(payload()); }
+        // Value of a string literal. Only a hex string has to be decoded, from digit pairs to bytes,
+        // anything else is the text itself.
+        std::string DecodeText() const;
+
+        // Bytes taken by a node of kind in the arena, header and payload included.
+        static size_t GetSize(NodeKind kind);
+        // Nodes constructed so far by the calling thread, for benchmarks.
+        static size_t GetCreatedCount();
+
+
+        static ASTNode* MakeIdentDefNode(ASTArena& arena, unsigned int pos, Atom name, bool isreadOnlyExport, bool isExport);
+        static ASTNode* MakeIdentNode(ASTArena& arena, unsigned int pos, Atom name);
+        static ASTNode* MakeQualidentNode(ASTArena& arena, unsigned int pos, Atom name1, Atom name2);
+        static ASTNode* MakeAssignmentNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeProcedureCallNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeModuleNode(
+                    ASTArena& arena, unsigned int pos, 
+                    Atom moduleName, ASTNode* left, 
+                    ASTNodeList nodes, 
+                    ASTNode* right);
+        static ASTNode* MakeDeclarationSequence2Node(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeDeclarationNode(ASTArena& arena, unsigned int pos, Atom name, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeImportListNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeImportAssignPathNode(ASTArena& arena, unsigned int pos, Atom left, Atom right, Atom next, ASTNode* last);
+        static ASTNode* MakeImportAssignNode(ASTArena& arena, unsigned int pos, Atom left, Atom right, ASTNode* next);
+        static ASTNode* MakeImportPathNode(ASTArena& arena, unsigned int pos, Atom left, Atom right, ASTNode* next);
+        static ASTNode* MakeImportNode(ASTArena& arena, unsigned int pos, Atom left, ASTNode* right);
+        static ASTNode* MakeLessCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeLessEqualCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeEqualCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeGreaterEqualCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeGreaterCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeNotEqualCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeInCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeIsCompareNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeUnaryPlusNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        static ASTNode* MakeUnaryMinusNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        static ASTNode* MakePlusNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeMinusNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeOrNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeMulNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeSlashNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeDivNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeModNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeAndNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeLiteralNumberNode(ASTArena& arena, unsigned int pos, NumberValue value);
+        static ASTNode* MakeLiteralStringNode(ASTArena& arena, unsigned int pos, std::string_view text);
+        static ASTNode* MakeLiteralHexStringNode(ASTArena& arena, unsigned int pos, std::string_view text);
+        static ASTNode* MakeLiteralHexCharNode(ASTArena& arena, unsigned int pos, NumberValue value);
+        static ASTNode* MakeLiteralNilNode(ASTArena& arena, unsigned int pos);
+        static ASTNode* MakeLiteralTrueNode(ASTArena& arena, unsigned int pos);
+        static ASTNode* MakeLiteralFalseNode(ASTArena& arena, unsigned int pos);
+        static ASTNode* MakeCallNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeBitInvertNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        // Operator nodes by kind: the relations, N_PLUS to N_AND, N_UNARY_PLUS, N_UNARY_MINUS and N_BIT_INVERT.
+        static ASTNode* MakeBinaryNode(ASTArena& arena, NodeKind kind, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeUnaryNode(ASTArena& arena, NodeKind kind, unsigned int pos, ASTNode* right);
+        static ASTNode* MakeExpressionListNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeStatementSequenceNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeIfStatementNode(
+                                            ASTArena& arena, unsigned int pos, 
+                                            ASTNode* left, 
+                                            ASTNode* right, 
+                                            ASTNodeList nodes,
+                                            ASTNode* next);
+        static ASTNode* MakeElsifStatementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeElseStatementNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        static ASTNode* MakeWhileStatementNode(
+                                            ASTArena& arena, unsigned int pos, 
+                                            ASTNode* left, 
+                                            ASTNode* right, 
+                                            ASTNodeList nodes);
+        static ASTNode* MakeCaseStatementNode(
+                                            ASTArena& arena, unsigned int pos, 
+                                            ASTNode* left, 
+                                            ASTNodeList nodes, 
+                                            ASTNode* right);
+        static ASTNode* MakeCaseStatement(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeCaseLabelRangeNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeLabelRangeNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeRepeatStatementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeForStatementNode(
+                                            ASTArena& arena, unsigned int pos,
+                                            Atom name,
+                                            ASTNode* left,
+                                            ASTNode* right,
+                                            ASTNode* next,
+                                            ASTNode* seq);
+        static ASTNode* WithStatementNode(
+                                            ASTArena& arena, unsigned int pos,
+                                            ASTNodeList GuardNodes,
+                                            ASTNodeList StatementBlockNodes,
+                                            ASTNode* elsePart);
+        static ASTNode* GuardNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeLoopStatementNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        static ASTNode* MakeExitStatementNode(ASTArena& arena, unsigned int pos);
+        static ASTNode* MakeReturnStatementNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        static ASTNode* MakeFormalParametersNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeFPSectionNode(
+                                            ASTArena& arena, unsigned int pos, 
+                                            AtomList names,
+                                            ASTNode* right,
                                             bool isVar,
                                             bool isIn);
-        static std::shared_ptr<ASTNode> MakeReciverNode(unsigned int line, unsigned int col, std::string left, std::string right);
-        static std::shared_ptr<ASTNode> MakeProcedureHeading(
-                                            unsigned int line, 
-                                            unsigned int col, 
+        static ASTNode* MakeReciverNode(ASTArena& arena, unsigned int pos, Atom left, Atom right, bool isVar, bool isIn);
+        static ASTNode* MakeProcedureHeading(
+                                            ASTArena& arena, unsigned int pos, 
                                             bool isProc, 
-                                            std::shared_ptr<ASTNode> reciver, 
-                                            std::shared_ptr<ASTNode> name, 
-                                            std::shared_ptr<ASTNode> parameters);
-        static std::shared_ptr<ASTNode> MakeProcedureDeclarationNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right, std::string name);
-        static std::shared_ptr<ASTNode> MakeProcedureBodyNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeSetNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeElementNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeActualParametersNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeDesignatorNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeDotNameNode(unsigned int line, unsigned int col, std::string text);
-        static std::shared_ptr<ASTNode> MakeCallQualidentNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeIndexNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeArrowNode(unsigned int line, unsigned int col);
-        static std::shared_ptr<ASTNode> MakeEnumerationNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::string>> nodes);
-        static std::shared_ptr<ASTNode> MakeArrayOfNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeArrayNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeLengthList(unsigned int line, unsigned int col, bool isVar, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeTypeParamsNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::string>> nodes);
-        static std::shared_ptr<ASTNode> MakeTypeActualsNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeRecordTypeNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeFieldListSequenceNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakeFieldListNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeIdentListNode(unsigned int line, unsigned int col, std::shared_ptr<std::vector<std::shared_ptr<ASTNode>>> nodes);
-        static std::shared_ptr<ASTNode> MakePointerNode(unsigned int line, unsigned int col, bool isArrow, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeProcedureTypeNode(unsigned int line, unsigned int col, bool isProc, bool isPointer, bool isArrow, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeVariableDeclarationNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeConstDeclarationNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
-        static std::shared_ptr<ASTNode> MakeTypeDeclarationNode(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left, std::shared_ptr<ASTNode> right);
+                                            ASTNode* reciver, 
+                                            ASTNode* name, 
+                                            ASTNode* parameters);
+        static ASTNode* MakeProcedureDeclarationNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right, Atom name);
+        static ASTNode* MakeProcedureBodyNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeSetNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeElementNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeActualParametersNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        static ASTNode* MakeDesignatorNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNodeList nodes);
+        static ASTNode* MakeDotNameNode(ASTArena& arena, unsigned int pos, Atom name);
+        static ASTNode* MakeCallQualidentNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        static ASTNode* MakeIndexNode(ASTArena& arena, unsigned int pos, ASTNode* right);
+        static ASTNode* MakeArrowNode(ASTArena& arena, unsigned int pos);
+        static ASTNode* MakeEnumerationNode(ASTArena& arena, unsigned int pos, AtomList names);
+        static ASTNode* MakeArrayOfNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeArrayNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeLengthList(ASTArena& arena, unsigned int pos, bool isVar, ASTNodeList nodes);
+        static ASTNode* MakeTypeParamsNode(ASTArena& arena, unsigned int pos, AtomList names);
+        static ASTNode* MakeTypeActualsNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeRecordTypeNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeFieldListSequenceNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakeFieldListNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeIdentListNode(ASTArena& arena, unsigned int pos, ASTNodeList nodes);
+        static ASTNode* MakePointerNode(ASTArena& arena, unsigned int pos, bool isArrow, ASTNode* right);
+        static ASTNode* MakeProcedureTypeNode(ASTArena& arena, unsigned int pos, bool isProc, bool isPointer, bool isArrow, ASTNode* right);
+        static ASTNode* MakeVariableDeclarationNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeConstDeclarationNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* MakeTypeDeclarationNode(ASTArena& arena, unsigned int pos, ASTNode* left, ASTNode* right);
 
     private:
-        unsigned int m_Line;
-        unsigned int m_Col;
+        friend class IncrementalParser;     // Splices re-parsed regions in and moves positions
+        friend class ASTShareTable;         // Marks the nodes it shares
+
+        static const unsigned short MARK_SHARED = 1;
+
+        ASTNode(NodeKind kind, unsigned int pos, unsigned int flags);
+
+        static ASTNode* make(ASTArena& arena, NodeKind kind, unsigned int pos, unsigned int flags = 0);
+        static ASTNode* make(ASTArena& arena, NodeKind kind, unsigned int pos, ASTNode* child);
+        static ASTNode* make(ASTArena& arena, NodeKind kind, unsigned int pos, ASTNode* left, ASTNode* right);
+        static ASTNode* share(ASTArena& arena, ASTNode* node);
+
+        ASTNode** children() const { return reinterpret_cast<ASTNode**>(const_cast<ASTNode*>(this) + 1); }
+        ASTNodeList* lists() const { return reinterpret_cast<ASTNodeList*>(children() + NODE_SHAPES[m_Kind].children); }
+        void* payload() const { return lists() + NODE_SHAPES[m_Kind].lists; }
+        void setName(unsigned int index, Atom name) { static_cast<Atom*>(payload())[index] = name; }
+
+        unsigned char m_Kind;
+        unsigned char m_Flags;
+        unsigned short m_Marks;         // MARK_ bits, not part of the syntax
+        unsigned int m_Pos;
 };
\ No newline at end of file
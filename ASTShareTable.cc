@@ -0,0 +1,125 @@
+#include "ASTShareTable.h"
+
+#include "ContentHash.h"
+
+static const size_t INITIAL_SLOTS = 1024;
+
+static inline size_t mixIn(size_t h, size_t value) {
+    h ^= value + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+ASTShareTable::ASTShareTable() {
+    m_Slots.assign(INITIAL_SLOTS, nullptr);
+    m_Count = 0;
+    m_Hits = 0;
+}
+
+bool ASTShareTable::IsShareable(NodeKind kind) {
+    switch (kind) {
+        case N_LESS: case N_LESS_EQUAL: case N_EQUAL: case N_GREATER_EQUAL: case N_GREATER: case N_NOT_EQUAL: case N_IN: case N_IS:
+        case N_UNARY_PLUS: case N_UNARY_MINUS: case N_PLUS: case N_MINUS: case N_OR: case N_MUL: case N_SLASH: case N_DIV: case N_MOD: case N_AND:
+        case N_NUMBER: case N_STRING: case N_HEX_STRING: case N_HEX_CHAR: case N_NIL: case N_TRUE: case N_FALSE:
+        case N_BIT_INVERT:
+        case N_SET:
+        case N_ELEMENT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+ASTNode* ASTShareTable::Intern(ASTNode* node) {
+    if (!IsShareable(node->GetKind())) return node;
+    for (unsigned int i = 0; i < node->GetChildCount(); i++) {
+        auto child = node->GetChild(i);
+        if (child != nullptr && !child->IsShared()) return node;
+    }
+    for (unsigned int i = 0; i < node->GetListCount(); i++) {
+        for (auto item : node->GetList(i)) if (!item->IsShared()) return node;
+    }
+
+    size_t mask = m_Slots.size() - 1;
+    for (size_t slot = hash(node) & mask; ; slot = (slot + 1) & mask) {
+        auto other = m_Slots[slot];
+        if (other == nullptr) {
+            m_Slots[slot] = node;
+            node->m_Marks |= ASTNode::MARK_SHARED;
+            if (++m_Count * 2 > m_Slots.size()) grow();
+            return node;
+        }
+        if (isEqual(node, other)) {
+            m_Hits++;
+            return other;
+        }
+    }
+}
+
+// Children are already shared, so their addresses stand for their contents.
+size_t ASTShareTable::hash(const ASTNode* node) {
+    auto& shape = NODE_SHAPES[node->GetKind()];
+    size_t h = mixIn(node->GetKind(), node->GetFlags());
+    for (unsigned int i = 0; i < shape.children; i++) h = mixIn(h, reinterpret_cast<size_t>(node->GetChild(i)));
+    for (unsigned int i = 0; i < shape.lists; i++) {
+        auto list = node->GetList(i);
+        h = mixIn(h, list.GetCount());
+        for (auto item : list) h = mixIn(h, reinterpret_cast<size_t>(item));
+    }
+    switch (shape.payload) {
+        case NP_NAMES:
+            for (unsigned int i = 0; i < shape.names; i++) h = mixIn(h, node->GetName(i));
+            break;
+        case NP_NUMBER:
+            {
+                auto value = node->GetNumber();
+                h = mixIn(mixIn(h, value.isReal), static_cast<size_t>(value.integer));
+            }
+            break;
+        case NP_TEXT:
+            {
+                auto text = node->GetText();
+                h = mixIn(h, HashContent(text.data(), text.size()));
+            }
+            break;
+        default:
+            break;
+    }
+    h *= 0xFF51AFD7ED558CCDull;   // Spreads the pointer bits into the low bits used as the slot
+    return h ^ (h >> 33);
+}
+
+bool ASTShareTable::isEqual(const ASTNode* a, const ASTNode* b) {
+    if (a->GetKind() != b->GetKind() || a->GetFlags() != b->GetFlags()) return false;
+    auto& shape = NODE_SHAPES[a->GetKind()];
+    for (unsigned int i = 0; i < shape.children; i++) {
+        if (a->GetChild(i) != b->GetChild(i)) return false;
+    }
+    for (unsigned int i = 0; i < shape.lists; i++) {
+        auto left = a->GetList(i), right = b->GetList(i);
+        if (left.GetCount() != right.GetCount()) return false;
+        for (unsigned int j = 0; j < left.GetCount(); j++) if (left[j] != right[j]) return false;
+    }
+    switch (shape.payload) {
+        case NP_NAMES:
+            for (unsigned int i = 0; i < shape.names; i++) if (a->GetName(i) != b->GetName(i)) return false;
+            return true;
+        case NP_NUMBER:
+            return a->GetNumber().isReal == b->GetNumber().isReal && a->GetNumber().integer == b->GetNumber().integer;
+        case NP_TEXT:
+            return a->GetText() == b->GetText();
+        default:
+            return true;
+    }
+}
+
+void ASTShareTable::grow() {
+    std::vector<ASTNode*> slots(m_Slots.size() * 2, nullptr);
+    size_t mask = slots.size() - 1;
+    for (auto node : m_Slots) {
+        if (node == nullptr) continue;
+        size_t slot = hash(node) & mask;
+        while (slots[slot] != nullptr) slot = (slot + 1) & mask;
+        slots[slot] = node;
+    }
+    m_Slots.swap(slots);
+}
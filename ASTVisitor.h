@@ -0,0 +1,66 @@
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "ASTNode.h"
+
+#pragma once
+
+// Defaults for a visitor, derive from it and hide what the pass needs. Nothing is virtual, the
+// walker is instantiated for the visitor type and calls it directly.
+struct ASTVisitor {
+    // Pre-order, before the children. Returning false skips the children and the Leave call.
+    bool Enter(ASTNode*) { return true; }
+    // Post-order, after the children.
+    void Leave(ASTNode*) { }
+};
+
+// Depth first walk over a tree without recursion, so nesting depth is bounded by memory instead of
+// by the thread's stack. The pending nodes are kept on a stack in the heap that is reused from walk
+// to walk. Children are visited in slot order, then the items of the lists in list order, missing
+// children are skipped.
+class ASTWalker
+{
+    public:
+        template<typename Visitor>
+        void Walk(ASTNode* root, Visitor& visitor) {
+            if (root == nullptr) return;
+            m_Stack.clear();
+            m_Stack.push_back(reinterpret_cast<uintptr_t>(root));
+            while (!m_Stack.empty()) {
+                auto entry = m_Stack.back();
+                m_Stack.pop_back();
+                auto node = reinterpret_cast<ASTNode*>(entry & ~LEAVE);
+                if (entry & LEAVE) {
+                    visitor.Leave(node);
+                    continue;
+                }
+                if (!visitor.Enter(node)) continue;
+                if (HasLeave<Visitor>()) m_Stack.push_back(entry | LEAVE);
+                pushChildren(node);
+            }
+        }
+
+    private:
+        // A visitor that keeps the default Leave gets no post-order entries on the stack.
+        template<typename Visitor>
+        static constexpr bool HasLeave() { return !std::is_same<decltype(&Visitor::Leave), decltype(&ASTVisitor::Leave)>::value; }
+
+        // Nodes are at least 4 byte aligned, the low bit of an entry marks the Leave of its node.
+        static const uintptr_t LEAVE = 1;
+
+        // Pushed last to first, so the first child comes off the stack first.
+        void pushChildren(ASTNode* node) {
+            auto& shape = NODE_SHAPES[node->GetKind()];
+            for (unsigned int i = shape.lists; i-- > 0; ) {
+                auto list = node->GetList(i);
+                for (auto item = list.end(); item != list.begin(); ) m_Stack.push_back(reinterpret_cast<uintptr_t>(*--item));
+            }
+            for (unsigned int i = shape.children; i-- > 0; ) {
+                auto child = node->GetChild(i);
+                if (child != nullptr) m_Stack.push_back(reinterpret_cast<uintptr_t>(child));
+            }
+        }
+
+        std::vector<uintptr_t> m_Stack;         // Pending nodes, grown but never shrunk
+};
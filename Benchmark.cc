@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ASTCache.h"
+#include "ASTNode.h"
+#include "ASTShareTable.h"
+#include "ASTVisitor.h"
+#include "CharScan.h"
+#include "ContentHash.h"
+#include "CorpusGenerator.h"
+#include "IncrementalParser.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include "SymbolFile.h"
+#include "Tokenizer.h"
+#include "TokenStream.h"
+
+// Usage: obx_bench [--corpus name|all] [--mode name|all] [--scan level|all] [--size MB] [--seed n]
+//                  [--repeat n] [--format text|json|csv] [--label text] [--emit file]
+//
+// Every run generates its corpus from the seed, so results of different commits are comparable.
+// --format json prints one object per line, append them to a file per commit to track a trend.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocation counting ////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<size_t> s_Allocations { 0 };
+
+void* operator new(size_t size) {
+    s_Allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Modes //////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef enum { MODE_LEX, MODE_PARSE, MODE_PARSE_PRELEX, MODE_PARSE_ASYNC, MODE_PARSE_SHARE, MODE_PIPELINE, MODE_WALK, MODE_VISIT, MODE_CACHE, MODE_REPARSE, MODE_CHECK, MODE_IMPORT } BenchMode;
+
+static const char* modeNames[] = { "lex", "parse", "parse-prelex", "parse-async", "parse-share", "pipeline", "walk", "visit", "cache", "reparse", "check", "import" };
+
+struct Measurement {
+    double seconds;
+    size_t tokens;
+    size_t nodes;
+    size_t allocations;
+    size_t treeBytes;       // Arena bytes taken by the tree
+};
+
+static volatile size_t s_Sink;
+
+// Visits every node once, the checksum keeps the compiler from dropping the loads.
+static size_t Walk(const ASTNode* node, size_t& checksum) {
+    if (node == nullptr) return 0;
+    checksum += node->GetKind() + node->GetPosition();
+    size_t count = 1;
+    for (unsigned int i = 0; i < node->GetChildCount(); i++) count += Walk(node->GetChild(i), checksum);
+    for (unsigned int i = 0; i < node->GetListCount(); i++) {
+        for (auto child : node->GetList(i)) count += Walk(child, checksum);
+    }
+    return count;
+}
+
+// The same visit as Walk, driven by an ASTWalker.
+struct CountingVisitor : ASTVisitor {
+    size_t count = 0;
+    size_t checksum = 0;
+
+    bool Enter(ASTNode* node) {
+        checksum += node->GetKind() + node->GetPosition();
+        count++;
+        return true;
+    }
+};
+
+// A one line edit inside a procedure: renames the variable assigned to about halfway through the text.
+static TextEdit MakeEdit(const std::shared_ptr<SourceBuffer>& source) {
+    std::string_view text(source->GetData(), source->GetLength());
+    for (auto at = text.find(" := ", text.size() / 2); at != std::string_view::npos; at = text.find(" := ", at + 1)) {
+        if (isalnum(static_cast<unsigned char>(text[at - 1]))) return TextEdit { static_cast<unsigned int>(at), 0, "x" };
+    }
+    throw std::runtime_error("No assignment to edit in the corpus");
+}
+
+// Copy of the corpus with a syntax error about every 4 KB, a ')' right behind the ':=' of an assignment.
+static std::shared_ptr<SourceBuffer> BreakSource(const std::shared_ptr<SourceBuffer>& source) {
+    std::string text(source->GetData(), source->GetLength());
+    for (auto at = text.find(" := "); at != std::string::npos; at = text.find(" := ", at + 4096)) text.insert(at + 4, ")");
+    return SourceBuffer::FromString(std::move(text));
+}
+
+// One pass over the corpus. Lex only drives the Tokenizer, the parse modes feed the Parser through a
+// TokenStream filled interleaved, up front or by a worker thread. The pipeline mode starts from the
+// file on disk and includes mapping it and tearing the tree down again. Walk parses untimed and then
+// times a recursive traversal of the finished tree, visit times the iterative ASTWalker over it. Cache is the warm build path that replaces lexing
+// and parsing an unchanged file: hash the source, map its AST cache and check that it matches.
+// Reparse parses untimed and then times bringing the tree up to date after a one line edit.
+// Parse-share parses with an ASTShareTable on the arena, its B/node is tree bytes per node made.
+// Check parses the corpus broken by BreakSource in recovery mode and reports every error.
+// Import is what an importer pays instead of parsing the module: map its symbol file and look up
+// every exported name, its Mnode/s are lookups.
+static Measurement RunOnce(BenchMode mode, const std::shared_ptr<SourceBuffer>& source, const std::string& fileName) {
+    Measurement result = { 0, 0, 0, 0, 0 };
+    std::shared_ptr<ASTArena> walkArena;
+    ASTNode* walkTree = nullptr;
+    if (mode == MODE_WALK || mode == MODE_VISIT || mode == MODE_CACHE || mode == MODE_IMPORT) {
+        walkArena = std::make_shared<ASTArena>();
+        auto lexer = std::make_shared<Tokenizer>(source);
+        Parser parser(lexer, walkArena);
+        walkTree = parser.ParseOberon();
+        if (mode == MODE_CACHE && access((fileName + ".obxc").c_str(), F_OK) != 0) {
+            ASTCache::Write(fileName + ".obxc", walkTree, *lexer->GetNames(), HashContent(source->GetData(), source->GetLength()), source->GetLength());
+        }
+        if (mode == MODE_IMPORT && access((fileName + ".obxs").c_str(), F_OK) != 0) {
+            SymbolFile::Write(fileName + ".obxs", walkTree, *lexer->GetNames(), HashContent(source->GetData(), source->GetLength()), source->GetLength());
+        }
+    }
+    std::unique_ptr<IncrementalParser> editor;
+    TextEdit edit;
+    if (mode == MODE_REPARSE) {
+        editor.reset(new IncrementalParser(source));
+        edit = MakeEdit(source);
+    }
+    size_t nodesBefore = ASTNode::GetCreatedCount();
+    size_t allocationsBefore = s_Allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+
+    if (mode == MODE_CACHE) {
+        auto hash = HashContent(source->GetData(), source->GetLength());
+        auto cache = ASTCache::Open(fileName + ".obxc");
+        if (cache == nullptr || !cache->Matches(hash, source->GetLength())) throw std::runtime_error("AST cache does not match its source");
+        result.nodes = cache->GetNodeCount();
+    }
+    else if (mode == MODE_IMPORT) {
+        auto symbols = SymbolFile::Open(fileName + ".obxs");
+        if (symbols == nullptr) throw std::runtime_error("Can't open the symbol file of the corpus");
+        for (unsigned int i = 0; i < symbols->GetCount(); i++) {
+            if (symbols->Find(SymbolFile::GetExportName(symbols->GetExport(i))).IsNull()) throw std::runtime_error("Export not found in its symbol file");
+        }
+        result.nodes = symbols->GetCount();
+    }
+    else if (mode == MODE_REPARSE) {
+        auto used = editor->GetArena()->GetBytesUsed();
+        editor->Apply({ edit });
+        if (editor->GetReparsedKind() == N_KIND_COUNT) throw std::runtime_error("Edit was not re-parsed incrementally");
+        result.treeBytes = editor->GetArena()->GetBytesUsed() - used;
+    }
+    else if (mode == MODE_VISIT) {
+        ASTWalker walker;
+        CountingVisitor visitor;
+        walker.Walk(walkTree, visitor);
+        result.nodes = visitor.count;
+        s_Sink = visitor.checksum;
+        result.treeBytes = walkArena->GetBytesUsed();
+    }
+    else if (mode == MODE_WALK) {
+        size_t checksum = 0;
+        result.nodes = Walk(walkTree, checksum);
+        s_Sink = checksum;
+        result.treeBytes = walkArena->GetBytesUsed();
+    }
+    else if (mode == MODE_LEX) {
+        Tokenizer lexer(source);
+        do {
+            lexer.Advance();
+            result.tokens++;
+        } while (lexer.GetSymbol() != T_EOF);
+    }
+    else if (mode == MODE_CHECK) {
+        auto tokens = std::make_shared<TokenStream>(std::make_shared<Tokenizer>(source));
+        auto arena = std::make_shared<ASTArena>();
+        Parser parser(tokens, arena);
+        parser.EnableRecovery();
+        parser.ParseOberon();
+        if (parser.GetDiagnostics().empty()) throw std::runtime_error("No syntax errors found in the broken corpus");
+        result.tokens = tokens->GetCount() - 1;
+        result.treeBytes = arena->GetBytesUsed();
+    }
+    else {
+        auto input = mode == MODE_PIPELINE ? SourceBuffer::FromFile(fileName) : source;
+        auto tokens = std::make_shared<TokenStream>(std::make_shared<Tokenizer>(input));
+        if (mode == MODE_PARSE_PRELEX) tokens->PreLex();
+        else if (mode == MODE_PARSE_ASYNC) tokens->PreLexAsync();
+        auto arena = std::make_shared<ASTArena>();
+        if (mode == MODE_PARSE_SHARE) arena->SetShareTable(std::make_shared<ASTShareTable>());
+        Parser parser(tokens, arena);
+        parser.ParseOberon();
+        result.tokens = tokens->GetCount() - 1;
+        result.treeBytes = arena->GetBytesUsed();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    if (mode != MODE_WALK && mode != MODE_VISIT && mode != MODE_CACHE && mode != MODE_IMPORT) result.nodes = ASTNode::GetCreatedCount() - nodesBefore;
+    result.allocations = s_Allocations.load(std::memory_order_relaxed) - allocationsBefore;
+    return result;
+}
+
+// Best wall time out of repeat runs, the counts are the same for every run.
+static Measurement RunBest(BenchMode mode, const std::shared_ptr<SourceBuffer>& source, const std::string& fileName, int repeat) {
+    Measurement best = RunOnce(mode, source, fileName);
+    for (int r = 1; r < repeat; r++) {
+        auto next = RunOnce(mode, source, fileName);
+        if (next.seconds < best.seconds) best = next;
+    }
+    return best;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reporting //////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef enum { FORMAT_TEXT, FORMAT_JSON, FORMAT_CSV } ReportFormat;
+
+static void Report(ReportFormat format, const std::string& label, const char* corpus, const char* mode, const char* scan,
+                   size_t bytes, const Measurement& m) {
+    double tokensPerSecond = m.tokens / m.seconds;
+    double bytesPerSecond = bytes / m.seconds;
+    double nodesPerSecond = m.nodes / m.seconds;
+    double allocationsPerKB = m.allocations / (bytes / 1024.0);
+    double bytesPerNode = m.nodes != 0 ? static_cast<double>(m.treeBytes) / m.nodes : 0;
+    char line[640];
+    switch (format) {
+        case FORMAT_JSON:
+            snprintf(line, sizeof(line),
+                     "{\"label\":\"%s\",\"corpus\":\"%s\",\"mode\":\"%s\",\"scan\":\"%s\",\"bytes\":%zu,\"tokens\":%zu,\"nodes\":%zu,"
+                     "\"seconds\":%.6f,\"tokens_per_s\":%.0f,\"bytes_per_s\":%.0f,\"nodes_per_s\":%.0f,\"allocs_per_kb\":%.3f,\"tree_bytes\":%zu,"
+                     "\"bytes_per_node\":%.2f}",
+                     label.c_str(), corpus, mode, scan, bytes, m.tokens, m.nodes, m.seconds, tokensPerSecond, bytesPerSecond, nodesPerSecond, allocationsPerKB,
+                     m.treeBytes, bytesPerNode);
+            break;
+        case FORMAT_CSV:
+            snprintf(line, sizeof(line), "%s,%s,%s,%s,%zu,%zu,%zu,%.6f,%.0f,%.0f,%.0f,%.3f,%zu,%.2f",
+                     label.c_str(), corpus, mode, scan, bytes, m.tokens, m.nodes, m.seconds, tokensPerSecond, bytesPerSecond, nodesPerSecond, allocationsPerKB,
+                     m.treeBytes, bytesPerNode);
+            break;
+        default:
+            snprintf(line, sizeof(line), "  %-13s %-12s %-6s %9.1f MB/s %8.2f Mtok/s %8.2f Mnode/s %8.1f alloc/KB %6.1f B/node",
+                     corpus, mode, scan, bytesPerSecond / (1024.0 * 1024.0), tokensPerSecond / 1e6, nodesPerSecond / 1e6, allocationsPerKB, bytesPerNode);
+            break;
+    }
+    std::cout << line << std::endl;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Driver /////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void Usage() {
+    std::cerr << "usage: obx_bench [--corpus name|all] [--mode name|all] [--scan scalar|sse2|avx2|all] [--size MB]" << std::endl
+              << "                 [--seed n] [--repeat n] [--format text|json|csv] [--label text] [--emit file]" << std::endl
+              << "corpora:";
+    for (size_t i = 0; i < CORPUS_PROFILE_COUNT; i++) std::cerr << " " << CORPUS_PROFILES[i].name;
+    std::cerr << std::endl << "modes:";
+    for (auto name : modeNames) std::cerr << " " << name;
+    std::cerr << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string corpusName = "all", modeName = "all", scanName = "best", label, emitFile;
+    size_t size = 16u << 20;
+    unsigned long long seed = 1;
+    int repeat = 3;
+    ReportFormat format = FORMAT_TEXT;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            Usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (option == "--corpus") corpusName = value;
+        else if (option == "--mode") modeName = value;
+        else if (option == "--scan") scanName = value;
+        else if (option == "--size") size = std::stoul(value) << 20;
+        else if (option == "--seed") seed = std::stoull(value);
+        else if (option == "--repeat") repeat = std::max(1, std::stoi(value));
+        else if (option == "--label") label = value;
+        else if (option == "--emit") emitFile = value;
+        else if (option == "--format") format = value == "json" ? FORMAT_JSON : value == "csv" ? FORMAT_CSV : FORMAT_TEXT;
+        else {
+            Usage();
+            return 1;
+        }
+    }
+
+    std::vector<const CorpusProfile*> corpora;
+    for (size_t i = 0; i < CORPUS_PROFILE_COUNT; i++) {
+        if (corpusName == "all" || corpusName == CORPUS_PROFILES[i].name) corpora.push_back(&CORPUS_PROFILES[i]);
+    }
+    std::vector<BenchMode> modes;
+    for (int mode = MODE_LEX; mode <= MODE_IMPORT; mode++) {
+        if (modeName == "all" || modeName == modeNames[mode]) modes.push_back(static_cast<BenchMode>(mode));
+    }
+    auto best = DetectScanLevel();
+    std::vector<ScanLevel> levels;
+    for (int level = SCAN_SCALAR; level <= best; level++) {
+        auto scanLevel = static_cast<ScanLevel>(level);
+        if (scanName == "all" || scanName == GetScanLevelName(scanLevel) || (scanName == "best" && scanLevel == best)) levels.push_back(scanLevel);
+    }
+    if (corpora.empty() || modes.empty() || levels.empty()) {
+        Usage();
+        return 1;
+    }
+
+    if (!emitFile.empty()) {
+        std::ofstream out(emitFile, std::ios::binary);
+        out << CorpusGenerator(*corpora[0], seed).Generate(size);
+        return out ? 0 : 1;
+    }
+
+    if (format == FORMAT_CSV) std::cout << "label,corpus,mode,scan,bytes,tokens,nodes,seconds,tokens_per_s,bytes_per_s,nodes_per_s,allocs_per_kb,tree_bytes,bytes_per_node" << std::endl;
+    for (auto profile : corpora) {
+        auto source = SourceBuffer::FromString(CorpusGenerator(*profile, seed).Generate(size));
+        std::string fileName;
+        if (std::find(modes.begin(), modes.end(), MODE_PIPELINE) != modes.end() || std::find(modes.begin(), modes.end(), MODE_CACHE) != modes.end()
+            || std::find(modes.begin(), modes.end(), MODE_IMPORT) != modes.end()) {
+            char pattern[] = "/tmp/obx_bench_XXXXXX";
+            int fd = mkstemp(pattern);
+            if (fd < 0 || write(fd, source->GetData(), source->GetLength()) != static_cast<ssize_t>(source->GetLength())) {
+                std::cerr << "Can't write corpus file for the pipeline mode!" << std::endl;
+                return 1;
+            }
+            close(fd);
+            fileName = pattern;
+        }
+        auto broken = std::find(modes.begin(), modes.end(), MODE_CHECK) != modes.end() ? BreakSource(source) : nullptr;
+        if (format == FORMAT_TEXT) {
+            std::cout << profile->name << ", " << std::fixed << std::setprecision(1) << source->GetLength() / (1024.0 * 1024.0) << " MB" << std::endl;
+        }
+        for (auto mode : modes) {
+            for (auto level : levels) {
+                SetScanLevel(level);
+                try {
+                    auto m = RunBest(mode, mode == MODE_CHECK ? broken : source, fileName, repeat);
+                    Report(format, label, profile->name, modeNames[mode], GetScanLevelName(level), source->GetLength(), m);
+                }
+                catch (const SyntaxError& e) {
+                    std::cerr << profile->name << ": " << e.GetExceptionDetails() << std::endl;
+                }
+                catch (std::exception& e) {
+                    std::cerr << profile->name << ": " << e.what() << std::endl;
+                }
+            }
+        }
+        if (!fileName.empty()) {
+            unlink(fileName.c_str());
+            unlink((fileName + ".obxc").c_str());
+            unlink((fileName + ".obxs").c_str());
+        }
+    }
+    SetScanLevel(best);
+    return 0;
+}
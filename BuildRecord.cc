@@ -0,0 +1,69 @@
+#include "BuildRecord.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "ContentHash.h"
+
+BuildRecord::BuildRecord(unsigned long long sourceHash, unsigned long long sourceLength, unsigned long long fingerprint) {
+    m_SourceHash = sourceHash;
+    m_SourceLength = sourceLength;
+    m_Fingerprint = fingerprint;
+}
+
+void BuildRecord::SetImports(std::vector<std::pair<std::string, unsigned long long>> imports) {
+    std::sort(imports.begin(), imports.end());
+    m_Imports = std::move(imports);
+}
+
+std::shared_ptr<BuildRecord> BuildRecord::Load(const std::string& fileName) {
+    std::ifstream in(fileName);
+    std::string magic, key;
+    unsigned int version = 0;
+    unsigned long long sourceHash, sourceLength, fingerprint;
+    if (!(in >> magic >> version) || magic != "OBXF" || version != VERSION) return nullptr;
+    if (!(in >> key >> std::hex >> sourceHash >> std::dec >> sourceLength) || key != "source") return nullptr;
+    if (!(in >> key >> std::hex >> fingerprint) || key != "fingerprint") return nullptr;
+
+    auto record = std::make_shared<BuildRecord>(sourceHash, sourceLength, fingerprint);
+    std::vector<std::pair<std::string, unsigned long long>> imports;
+    std::string name;
+    unsigned long long hash;
+    while (in >> key >> name >> std::hex >> hash) {
+        if (key != "import") return nullptr;
+        imports.emplace_back(name, hash);
+    }
+    if (!in.eof()) return nullptr;
+    record->SetImports(std::move(imports));
+    return record;
+}
+
+bool BuildRecord::Save(const std::string& fileName) const {
+    std::ostringstream text;
+    text << "OBXF " << VERSION << "\n";
+    text << "source " << FormatHash(m_SourceHash) << " " << m_SourceLength << "\n";
+    text << "fingerprint " << FormatHash(m_Fingerprint) << "\n";
+    for (auto& import : m_Imports) text << "import " << import.first << " " << FormatHash(import.second) << "\n";
+
+    auto tempName = fileName + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(tempName, std::ios::binary);
+        if (!(out << text.str()) || !out.flush()) {
+            unlink(tempName.c_str());
+            return false;
+        }
+    }
+    if (rename(tempName.c_str(), fileName.c_str()) != 0) {
+        unlink(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string BuildRecord::GetFileName(const std::string& directory, std::string_view moduleName) {
+    return directory + "/" + std::string(moduleName) + ".obxf";
+}
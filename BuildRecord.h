@@ -0,0 +1,44 @@
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+// What the last clean build of a module was made from, kept next to its symbol file as
+// <directory>/<module>.obxf. The fingerprint is the hash of the module's exported interface, see
+// SymbolFile::GetFingerprint, and the imports are the fingerprints of the modules it imported when
+// it was compiled. A module whose source and import fingerprints are still the same need not be
+// compiled again, and a module whose body changed but not its exports leaves its importers alone.
+//
+// A small text file: a "OBXF <version>" line, "source <hash> <length>", "fingerprint <hash>" and one
+// "import <module> <hash>" line per import, hashes in hex.
+class BuildRecord
+{
+    public:
+        static const unsigned int VERSION = 1;
+
+        BuildRecord(unsigned long long sourceHash, unsigned long long sourceLength, unsigned long long fingerprint);
+
+        // Returns nullptr if the record can't be read or is not of this version.
+        static std::shared_ptr<BuildRecord> Load(const std::string& fileName);
+        // Written under a temporary name and renamed into place, like ASTCache::Write.
+        bool Save(const std::string& fileName) const;
+        // <directory>/<module>.obxf
+        static std::string GetFileName(const std::string& directory, std::string_view moduleName);
+
+        bool Matches(unsigned long long sourceHash, unsigned long long sourceLength) const {
+            return m_SourceHash == sourceHash && m_SourceLength == sourceLength;
+        }
+        unsigned long long GetFingerprint() const { return m_Fingerprint; }
+        // Sorted by module name.
+        const std::vector<std::pair<std::string, unsigned long long>>& GetImports() const { return m_Imports; }
+        void SetImports(std::vector<std::pair<std::string, unsigned long long>> imports);
+
+    private:
+        unsigned long long m_SourceHash;
+        unsigned long long m_SourceLength;
+        unsigned long long m_Fingerprint;
+        std::vector<std::pair<std::string, unsigned long long>> m_Imports;
+};
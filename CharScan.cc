@@ -0,0 +1,256 @@
+#include "CharScan.h"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CHARSCAN_X86 1
+#endif
+
+typedef const char* (*ScanFunction)(const char* p, const char* end);
+typedef const char* (*StringScanFunction)(const char* p, const char* end, char quote);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar /////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* scanCommentTextScalar(const char* p, const char* end) {
+    while (p < end && *p != '*' && *p != '\0') p++;
+    return p;
+}
+
+static const char* scanWhitespaceScalar(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+static const char* scanLineBreakScalar(const char* p, const char* end) {
+    while (p < end && *p != '\r' && *p != '\n') p++;
+    return p;
+}
+
+static const char* scanStringTextScalar(const char* p, const char* end, char quote) {
+    while (p < end && *p != quote && *p != '\r' && *p != '\n' && *p != '\0' && (*p & 0x80) == 0) p++;
+    return p;
+}
+
+#ifdef CHARSCAN_X86
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SSE2, 16 bytes at a time ///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("sse2")))
+static const char* scanCommentTextSSE2(const char* p, const char* end) {
+    const __m128i star = _mm_set1_epi8('*'), nul = _mm_setzero_si128();
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, star), _mm_cmpeq_epi8(v, nul));
+        unsigned int mask = _mm_movemask_epi8(hit);
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scanCommentTextScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+static const char* scanWhitespaceSSE2(const char* p, const char* end) {
+    const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'), cr = _mm_set1_epi8('\r'), lf = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+        unsigned int mask = ~_mm_movemask_epi8(blank) & 0xFFFFu;
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scanWhitespaceScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+static const char* scanLineBreakSSE2(const char* p, const char* end) {
+    const __m128i cr = _mm_set1_epi8('\r'), lf = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scanLineBreakScalar(p, end);
+}
+
+// The sign bit of each byte is already the non ASCII test, so movemask of the data itself is or'ed in.
+__attribute__((target("sse2")))
+static const char* scanStringTextSSE2(const char* p, const char* end, char quote) {
+    const __m128i q = _mm_set1_epi8(quote), cr = _mm_set1_epi8('\r'), lf = _mm_set1_epi8('\n'), nul = _mm_setzero_si128();
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, nul)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+        unsigned int mask = _mm_movemask_epi8(_mm_or_si128(hit, v));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scanStringTextScalar(p, end, quote);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AVX2, 32 bytes at a time ///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2")))
+static const char* scanCommentTextAVX2(const char* p, const char* end) {
+    const __m256i star = _mm256_set1_epi8('*'), nul = _mm256_setzero_si256();
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, star), _mm256_cmpeq_epi8(v, nul));
+        unsigned int mask = _mm256_movemask_epi8(hit);
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return scanCommentTextSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* scanWhitespaceAVX2(const char* p, const char* end) {
+    const __m256i space = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t'), cr = _mm256_set1_epi8('\r'), lf = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i blank = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)));
+        unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(blank));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return scanWhitespaceSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* scanLineBreakAVX2(const char* p, const char* end) {
+    const __m256i cr = _mm256_set1_epi8('\r'), lf = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned int mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return scanLineBreakSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* scanStringTextAVX2(const char* p, const char* end, char quote) {
+    const __m256i q = _mm256_set1_epi8(quote), cr = _mm256_set1_epi8('\r'), lf = _mm256_set1_epi8('\n'), nul = _mm256_setzero_si256();
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, q), _mm256_cmpeq_epi8(v, nul)),
+                                      _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)));
+        unsigned int mask = _mm256_movemask_epi8(_mm256_or_si256(hit, v));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return scanStringTextSSE2(p, end, quote);
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Runtime dispatch ///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* resolveCommentText(const char* p, const char* end);
+static const char* resolveWhitespace(const char* p, const char* end);
+static const char* resolveLineBreak(const char* p, const char* end);
+static const char* resolveStringText(const char* p, const char* end, char quote);
+
+// Constant initialised, the first call through either pointer selects the real implementation.
+static std::atomic<ScanFunction> s_CommentText { resolveCommentText };
+static std::atomic<ScanFunction> s_Whitespace { resolveWhitespace };
+static std::atomic<ScanFunction> s_LineBreak { resolveLineBreak };
+static std::atomic<StringScanFunction> s_StringText { resolveStringText };
+static std::atomic<int> s_Level { -1 };
+
+ScanLevel DetectScanLevel() {
+#ifdef CHARSCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SCAN_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SCAN_SSE2;
+#endif
+    return SCAN_SCALAR;
+}
+
+void SetScanLevel(ScanLevel level) {
+    auto best = DetectScanLevel();
+    if (level > best) level = best;
+    switch (level) {
+#ifdef CHARSCAN_X86
+        case SCAN_AVX2:
+            s_CommentText.store(scanCommentTextAVX2, std::memory_order_relaxed);
+            s_Whitespace.store(scanWhitespaceAVX2, std::memory_order_relaxed);
+            s_LineBreak.store(scanLineBreakAVX2, std::memory_order_relaxed);
+            s_StringText.store(scanStringTextAVX2, std::memory_order_relaxed);
+            break;
+        case SCAN_SSE2:
+            s_CommentText.store(scanCommentTextSSE2, std::memory_order_relaxed);
+            s_Whitespace.store(scanWhitespaceSSE2, std::memory_order_relaxed);
+            s_LineBreak.store(scanLineBreakSSE2, std::memory_order_relaxed);
+            s_StringText.store(scanStringTextSSE2, std::memory_order_relaxed);
+            break;
+#endif
+        default:
+            s_CommentText.store(scanCommentTextScalar, std::memory_order_relaxed);
+            s_Whitespace.store(scanWhitespaceScalar, std::memory_order_relaxed);
+            s_LineBreak.store(scanLineBreakScalar, std::memory_order_relaxed);
+            s_StringText.store(scanStringTextScalar, std::memory_order_relaxed);
+            break;
+    }
+    s_Level.store(level, std::memory_order_relaxed);
+}
+
+ScanLevel GetScanLevel() {
+    if (s_Level.load(std::memory_order_relaxed) < 0) SetScanLevel(DetectScanLevel());
+    return static_cast<ScanLevel>(s_Level.load(std::memory_order_relaxed));
+}
+
+const char* GetScanLevelName(ScanLevel level) {
+    switch (level) {
+        case SCAN_AVX2:     return "avx2";
+        case SCAN_SSE2:     return "sse2";
+        default:            return "scalar";
+    }
+}
+
+static const char* resolveCommentText(const char* p, const char* end) {
+    GetScanLevel();
+    return s_CommentText.load(std::memory_order_relaxed)(p, end);
+}
+
+static const char* resolveWhitespace(const char* p, const char* end) {
+    GetScanLevel();
+    return s_Whitespace.load(std::memory_order_relaxed)(p, end);
+}
+
+static const char* resolveLineBreak(const char* p, const char* end) {
+    GetScanLevel();
+    return s_LineBreak.load(std::memory_order_relaxed)(p, end);
+}
+
+static const char* resolveStringText(const char* p, const char* end, char quote) {
+    GetScanLevel();
+    return s_StringText.load(std::memory_order_relaxed)(p, end, quote);
+}
+
+const char* ScanCommentText(const char* p, const char* end) {
+    return s_CommentText.load(std::memory_order_relaxed)(p, end);
+}
+
+const char* ScanWhitespace(const char* p, const char* end) {
+    return s_Whitespace.load(std::memory_order_relaxed)(p, end);
+}
+
+const char* ScanLineBreak(const char* p, const char* end) {
+    return s_LineBreak.load(std::memory_order_relaxed)(p, end);
+}
+
+const char* ScanStringText(const char* p, const char* end, char quote) {
+    return s_StringText.load(std::memory_order_relaxed)(p, end, quote);
+}
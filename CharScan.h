@@ -0,0 +1,25 @@
+#include <cstddef>
+
+#pragma once
+
+// Instruction set used by the bulk character scanners. Picked at runtime from what the CPU supports.
+typedef enum {
+    SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2
+} ScanLevel;
+
+// Best level the running CPU supports.
+ScanLevel DetectScanLevel();
+// Level currently in use.
+ScanLevel GetScanLevel();
+// Forces a level, clamped to what the CPU supports. Mostly for benchmarks and testing.
+void SetScanLevel(ScanLevel level);
+const char* GetScanLevelName(ScanLevel level);
+
+// First byte in [p, end) that is '*' or '\0', end if there is none.
+const char* ScanCommentText(const char* p, const char* end);
+// First byte in [p, end) that is not ' ', '\t', '\r' or '\n', end if there is none.
+const char* ScanWhitespace(const char* p, const char* end);
+// First byte in [p, end) that is '\r' or '\n', end if there is none.
+const char* ScanLineBreak(const char* p, const char* end);
+// First byte in [p, end) that is quote, '\r', '\n', '\0' or not ASCII, end if there is none.
+const char* ScanStringText(const char* p, const char* end, char quote);
@@ -0,0 +1,125 @@
+#include "CompileCache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <tuple>
+
+#include "ContentHash.h"
+
+// Tells apart the temporary files of threads in one process, the process id does the rest.
+static std::atomic<unsigned int> s_TempCount { 0 };
+
+CompileCache::CompileCache(const std::string& directory, unsigned long long maxBytes) : m_Hits(0), m_Misses(0), m_Stores(0), m_Evictions(0), m_StoredBytes(0) {
+    m_Directory = directory;
+    m_MaxBytes = maxBytes;
+    m_Bytes = 0;
+    m_IsMeasured = false;
+}
+
+bool CompileCache::Open() {
+    std::error_code error;
+    std::filesystem::create_directories(m_Directory, error);
+    return !error && std::filesystem::is_directory(m_Directory, error);
+}
+
+std::string CompileCache::MakeKey(const std::string& step, unsigned long long sourceHash, unsigned long long sourceLength,
+                                  const std::vector<std::pair<std::string, unsigned long long>>& imports) {
+    std::string inputs = std::string(COMPILER_VERSION) + '\0' + step + '\0' + FormatHash(sourceHash) + FormatHash(sourceLength);
+    for (auto& import : imports) inputs += '\0' + import.first + '\0' + FormatHash(import.second);
+    return FormatHash(HashContent(inputs.data(), inputs.size())) + FormatHash(HashContent(inputs.data(), inputs.size(), 0x5CA1AB1Eull));
+}
+
+std::string CompileCache::entryName(const std::string& key, const std::string& kind) const {
+    return m_Directory + "/" + key.substr(0, 2) + "/" + key + "." + kind;
+}
+
+// A hard link where the file system allows it, a copy otherwise, renamed into place either way.
+bool CompileCache::place(const std::string& from, const std::string& to) {
+    auto tempName = to + ".tmp" + std::to_string(getpid()) + "." + std::to_string(s_TempCount.fetch_add(1));
+    if (link(from.c_str(), tempName.c_str()) != 0) {
+        std::error_code error;
+        if (!std::filesystem::copy_file(from, tempName, std::filesystem::copy_options::overwrite_existing, error)) {
+            unlink(tempName.c_str());
+            return false;
+        }
+    }
+    if (rename(tempName.c_str(), to.c_str()) != 0) {
+        unlink(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CompileCache::Fetch(const std::string& key, const std::string& kind, const std::string& target) {
+    auto entry = entryName(key, kind);
+    bool isHit = target.empty() ? access(entry.c_str(), F_OK) == 0 : place(entry, target);
+    if (isHit) utimensat(AT_FDCWD, entry.c_str(), nullptr, 0);  // Marks it used for Trim
+    (isHit ? m_Hits : m_Misses)++;
+    return isHit;
+}
+
+bool CompileCache::Store(const std::string& key, const std::string& kind, const std::string& source) {
+    auto entry = entryName(key, kind);
+    if (access(entry.c_str(), F_OK) == 0) return true;
+    std::error_code error;
+    std::filesystem::create_directories(m_Directory + "/" + key.substr(0, 2), error);
+    if (error) return false;
+
+    bool isStored;
+    if (!source.empty()) {
+        isStored = place(source, entry);
+        std::error_code sizeError;
+        auto size = std::filesystem::file_size(entry, sizeError);
+        if (isStored && !sizeError) m_StoredBytes += size;
+    }
+    else {
+        auto tempName = entry + ".tmp" + std::to_string(getpid()) + "." + std::to_string(s_TempCount.fetch_add(1));
+        int fd = open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        isStored = fd >= 0 && close(fd) == 0 && rename(tempName.c_str(), entry.c_str()) == 0;
+        if (!isStored) unlink(tempName.c_str());
+    }
+    if (isStored) m_Stores++;
+    return isStored;
+}
+
+// Temporary files of writers that are still at work are left alone and not counted. A process
+// walks the directory the first time it stored something, after that only when its estimate is
+// over the limit. Other processes store to the directory too, so the estimate only runs low.
+void CompileCache::Trim() {
+    auto stored = m_StoredBytes.exchange(0);
+    if (m_IsMeasured && (stored == 0 || m_Bytes + stored <= m_MaxBytes)) {
+        m_Bytes += stored;
+        return;
+    }
+    if (!m_IsMeasured && m_Stores == 0) return;
+    std::vector<std::tuple<std::filesystem::file_time_type, unsigned long long, std::filesystem::path>> entries;
+    unsigned long long bytes = 0;
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(m_Directory, error);
+         !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        std::error_code entryError;
+        if (!it->is_regular_file(entryError) || it->path().filename().string().find(".tmp") != std::string::npos) continue;
+        auto size = it->file_size(entryError);
+        auto time = it->last_write_time(entryError);
+        if (entryError) continue;
+        entries.emplace_back(time, size, it->path());
+        bytes += size;
+    }
+
+    if (bytes > m_MaxBytes) {
+        std::sort(entries.begin(), entries.end());
+        for (auto& entry : entries) {
+            if (bytes <= m_MaxBytes) break;
+            if (!std::filesystem::remove(std::get<2>(entry), error)) continue;
+            bytes -= std::get<1>(entry);
+            m_Evictions++;
+        }
+    }
+    m_Bytes = bytes;
+    m_IsMeasured = true;
+}
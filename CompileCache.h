@@ -0,0 +1,68 @@
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+// Version of the compiler, part of every CompileCache key.
+const char* const COMPILER_VERSION = "0.01";
+
+// Content addressed store of compile outputs shared by every build on the machine. An entry is a
+// file named after a 128 bit key, the hash of everything the output was made from: the compiler
+// version, the step, the flags that change the output, the source bytes and the fingerprints of
+// the imports. So a module compiled once is found again after a clean checkout or a branch switch.
+// Entries are <directory>/<first two key digits>/<key>.<kind>.
+//
+// Entries are never changed, only made and removed, and both are single renames or unlinks, so any
+// number of compiler processes can use one directory without locks. A new entry is linked or copied
+// to a temporary name first and renamed into place. A reader that opened an entry keeps its data
+// when the entry is evicted under it. Fetching an entry marks it used, Trim evicts the least
+// recently used entries when the directory is over its size.
+class CompileCache
+{
+    public:
+        CompileCache(const std::string& directory, unsigned long long maxBytes);
+
+        // Makes the directory. False if it can't be made.
+        bool Open();
+
+        // 32 hex digits.
+        static std::string MakeKey(const std::string& step, unsigned long long sourceHash, unsigned long long sourceLength,
+                                   const std::vector<std::pair<std::string, unsigned long long>>& imports = {});
+
+        // Puts the entry under key at target, an empty target only looks whether the entry is there.
+        // Counts a hit or a miss.
+        bool Fetch(const std::string& key, const std::string& kind, const std::string& target);
+        // Adds the file at source as the entry under key, an empty source adds an empty entry. An
+        // entry that is already there is left as it is.
+        bool Store(const std::string& key, const std::string& kind, const std::string& source);
+        // Evicts entries, least recently used first, until the directory is within its size. The
+        // directory is only walked if something was stored since the last Trim, and once walked only
+        // if the size it had then plus what was stored since is over the limit.
+        void Trim();
+
+        unsigned long long GetHits() const { return m_Hits; }
+        unsigned long long GetMisses() const { return m_Misses; }
+        unsigned long long GetStores() const { return m_Stores; }
+        unsigned long long GetEvictions() const { return m_Evictions; }
+        // Of the directory as the last walk found it plus what was stored since, false before the
+        // first walk.
+        bool IsMeasured() const { return m_IsMeasured; }
+        unsigned long long GetBytes() const { return m_Bytes + m_StoredBytes; }
+
+    private:
+        std::string entryName(const std::string& key, const std::string& kind) const;
+        static bool place(const std::string& from, const std::string& to);
+
+        std::string m_Directory;
+        unsigned long long m_MaxBytes;
+        std::atomic<unsigned long long> m_Hits;
+        std::atomic<unsigned long long> m_Misses;
+        std::atomic<unsigned long long> m_Stores;
+        std::atomic<unsigned long long> m_Evictions;
+        std::atomic<unsigned long long> m_StoredBytes;  // Since the last Trim
+        unsigned long long m_Bytes;
+        bool m_IsMeasured;
+};
@@ -0,0 +1,487 @@
+#include "CompileDriver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+
+#include <unistd.h>
+
+#include "ASTCache.h"
+#include "ASTVisitor.h"
+#include "BuildRecord.h"
+#include "ContentHash.h"
+#include "SymbolFile.h"
+#include "Tokenizer.h"
+#include "TokenStream.h"
+
+CompileDriver::CompileDriver(unsigned int workers) : m_Scheduler(workers) {
+    m_Cycles = 0;
+    m_ScanSeconds = 0.0;
+    m_IsCaching = false;
+    m_IsRecovering = false;
+    m_IsResident = false;
+}
+
+bool CompileDriver::AddInput(const std::string& path) {
+    if (path == "-") {
+        addFile(path, 0);
+        return true;
+    }
+    std::error_code error;
+    auto status = std::filesystem::status(path, error);
+    if (error || !std::filesystem::exists(status)) return false;
+    if (!std::filesystem::is_directory(status)) {
+        addFile(path, std::filesystem::file_size(path, error));
+        return true;
+    }
+    // Directory order is whatever the file system returns, sorted so every run sees the same list.
+    std::vector<std::filesystem::path> files;
+    for (auto it = std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, error);
+         !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (it->is_regular_file(error) && it->path().extension() == ".obx") files.push_back(it->path());
+    }
+    std::sort(files.begin(), files.end());
+    for (auto& file : files) addFile(file.string(), std::filesystem::file_size(file, error));
+    return true;
+}
+
+bool CompileDriver::SetSymbolDirectory(const std::string& directory) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error || !std::filesystem::is_directory(directory, error)) return false;
+    m_SymbolDirectory = directory;
+    return true;
+}
+
+bool CompileDriver::SetCacheDirectory(const std::string& directory, unsigned long long maxBytes) {
+    m_Cache = std::make_unique<CompileCache>(directory, maxBytes);
+    if (m_Cache->Open()) return true;
+    m_Cache.reset();
+    return false;
+}
+
+void CompileDriver::ClearInputs() {
+    m_Units.clear();
+    m_Sources.clear();
+    m_ResidentUnits.clear();
+    m_Graph.reset();
+    m_Cycles = 0;
+    m_ScanSeconds = 0.0;
+}
+
+void CompileDriver::addFile(const std::string& fileName, size_t size) {
+    CompileUnit unit;
+    unit.fileName = fileName;
+    unit.size = size != static_cast<size_t>(-1) ? size : 0;
+    unit.isUnreadable = false;
+    unit.isSkipped = false;
+    unit.isCacheHit = false;
+    unit.isCacheUnwritable = false;
+    unit.isSymbolsUnwritable = false;
+    unit.isUpToDate = false;
+    unit.isRestored = false;
+    unit.isUnchanged = false;
+    unit.fingerprint = 0;
+    unit.worker = 0;
+    unit.seconds = 0.0;
+    m_Units.push_back(std::move(unit));
+}
+
+size_t CompileDriver::Run() {
+    m_Sources.assign(m_Units.size(), nullptr);
+    m_ResidentUnits.assign(m_Units.size(), nullptr);
+    if (m_IsResident) {
+        // A file given twice is remembered by its first unit only, two workers would write it.
+        std::unordered_set<ResidentFile*> claimed;
+        for (size_t i = 0; i < m_Units.size(); i++) {
+            if (m_Units[i].fileName == "-") continue;
+            auto resident = &m_Resident[m_Units[i].fileName];
+            if (claimed.insert(resident).second) m_ResidentUnits[i] = resident;
+        }
+    }
+    ModuleGraph files(std::vector<std::string>(m_Units.size()), {});
+    m_Scheduler.Run(files, [this](size_t index, unsigned int) { scan(index); });
+    m_ScanSeconds = m_Scheduler.GetWallSeconds();
+
+    std::vector<std::string> names;
+    std::vector<std::vector<std::string>> imports;
+    for (auto& unit : m_Units) {
+        names.push_back(unit.moduleName);
+        imports.push_back(unit.imports);
+    }
+    m_Graph = std::make_unique<ModuleGraph>(names, imports);
+    for (size_t i = 0; i < m_Units.size(); i++) {
+        auto first = m_Graph->GetDuplicate(i);
+        if (first != i) m_Units[i].importErrors.push_back("Module '" + names[i] + "' is already in '" + m_Units[first].fileName + "'!");
+    }
+    auto cycles = m_Graph->BreakCycles();
+    m_Cycles = cycles.size();
+    for (auto& cycle : cycles) {
+        std::string text = "Import cycle ";
+        for (auto node : cycle) text += names[node] + " -> ";
+        text += names[cycle.front()] + "!";
+        for (auto node : cycle) {
+            m_Units[node].importErrors.push_back(text);
+            m_Units[node].isSkipped = true;
+        }
+    }
+
+    // A module is worth starting early by the size of the longest chain of importers waiting on it.
+    auto order = m_Graph->GetImportOrder();
+    std::vector<double> priority(m_Units.size(), 0.0);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        double waiting = 0.0;
+        for (auto importer : m_Graph->GetImporters(*it)) waiting = std::max(waiting, priority[importer]);
+        priority[*it] = m_Units[*it].size + waiting;
+    }
+    m_Scheduler.Run(*m_Graph, [this](size_t index, unsigned int worker) {
+        auto start = std::chrono::steady_clock::now();
+        compile(index);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        m_Units[index].worker = worker;
+        m_Units[index].seconds = elapsed.count();
+    }, priority);
+    m_Sources.clear();
+    if (m_Cache != nullptr) m_Cache->Trim();
+
+    for (size_t i = 0; i < m_Units.size(); i++) {
+        auto resident = m_ResidentUnits[i];
+        if (resident == nullptr) continue;
+        auto& unit = m_Units[i];
+        resident->isValid = !unit.isUnreadable && !unit.isSkipped && unit.importErrors.empty() && !unit.isCacheUnwritable && !unit.isSymbolsUnwritable;
+        resident->moduleName = unit.moduleName;
+        resident->imports = unit.imports;
+        resident->fingerprint = unit.fingerprint;
+        resident->diagnostics = unit.diagnostics;
+    }
+
+    size_t failed = 0;
+    for (auto& unit : m_Units) {
+        if (isFailed(unit)) failed++;
+    }
+    return failed;
+}
+
+bool CompileDriver::isFailed(const CompileUnit& unit) {
+    return unit.isUnreadable || unit.isSkipped || !unit.diagnostics.empty() || !unit.importErrors.empty();
+}
+
+// A header that does not parse leaves the module without a name, the full parse reports the error.
+void CompileDriver::scan(size_t index) {
+    auto& unit = m_Units[index];
+    auto resident = m_ResidentUnits[index];
+    if (resident != nullptr) {
+        std::error_code error;
+        auto time = std::filesystem::last_write_time(unit.fileName, error);
+        size_t size = error ? 0 : std::filesystem::file_size(unit.fileName, error);
+        if (!error && resident->isValid && time == resident->time && size == resident->size) {
+            unit.moduleName = resident->moduleName;
+            unit.imports = resident->imports;
+            unit.isUnchanged = true;
+            return;
+        }
+        resident->time = time;
+        resident->size = size;
+    }
+    auto source = unit.fileName == "-" ? SourceBuffer::FromDescriptor(STDIN_FILENO) : SourceBuffer::FromFile(unit.fileName);
+    m_Sources[index] = source;
+    if (source == nullptr || source->IsStreaming()) return;
+
+    auto lexer = std::make_shared<Tokenizer>(source);
+    Parser parser(lexer);
+    ASTNode* node = nullptr;
+    try {
+        node = parser.ParseHeader();
+    }
+    catch (const SyntaxError&) {
+        return;
+    }
+    if (node == nullptr) return;
+
+    auto names = lexer->GetNames();
+    unit.moduleName = names->GetName(node->GetName());
+    auto addImports = [&unit, &names](ASTNode* list) {
+        if (list == nullptr) return;
+        for (auto import : list->GetList()) {
+            switch (import->GetKind()) {
+                case N_IMPORT:              unit.imports.emplace_back(names->GetName(import->GetName(0))); break;
+                case N_IMPORT_PATH:
+                case N_IMPORT_ASSIGN:       unit.imports.emplace_back(names->GetName(import->GetName(1))); break;
+                case N_IMPORT_ASSIGN_PATH:  unit.imports.emplace_back(names->GetName(import->GetName(2))); break;
+                default:                    break;
+            }
+        }
+    };
+    if (node->GetKind() == N_MODULE) {
+        for (auto list : node->GetList()) addImports(list);
+    }
+    else addImports(node->GetChild(0));
+}
+
+void CompileDriver::compile(size_t index) {
+    auto& unit = m_Units[index];
+    auto resident = m_ResidentUnits[index];
+    auto source = m_Sources[index];
+    m_Sources[index] = nullptr;
+    if (source == nullptr && !unit.isUnchanged) {
+        unit.isUnreadable = true;
+        return;
+    }
+    for (auto import : m_Graph->GetImports(index)) {
+        if (!unit.isSkipped && isFailed(m_Units[import])) {
+            unit.importErrors.push_back("Not compiled, imported module '" + m_Units[import].moduleName + "' failed!");
+            unit.isSkipped = true;
+        }
+    }
+    if (unit.isSkipped) return;
+
+    // With symbol files the build record decides whether the module is compiled, else the AST cache
+    // does. A module of a name used twice in the build keeps no symbol file, both would write it.
+    // An unchanged file of a resident driver was not read, its hash is the one remembered.
+    bool isStreaming = source != nullptr && source->IsStreaming();
+    unsigned long long sourceHash = 0;
+    unsigned long long sourceLength = source != nullptr ? source->GetLength() : resident->sourceLength;
+    std::string cacheName = unit.fileName + ".obxc";
+    auto symbolName = SymbolFile::GetFileName(m_SymbolDirectory, unit.moduleName);
+    bool isCached = m_IsCaching && !isStreaming;
+    bool isSymbolFileKept = !m_SymbolDirectory.empty() && !isStreaming && !unit.moduleName.empty() && m_Graph->GetDuplicate(index) == index;
+    if (source == nullptr) sourceHash = resident->sourceHash;
+    else if (isCached || isSymbolFileKept || m_Cache != nullptr || resident != nullptr) sourceHash = HashContent(source->GetData(), sourceLength);
+    std::vector<std::pair<std::string, unsigned long long>> fingerprints;
+    if (isSymbolFileKept) fingerprints = importFingerprints(index);
+
+    // A resident driver gives a file the result of the last Run if its content and import
+    // fingerprints are still the same, and the symbol file was not removed under it.
+    if (resident != nullptr) {
+        if (resident->isValid && resident->sourceHash == sourceHash && resident->sourceLength == sourceLength
+            && resident->importFingerprints == fingerprints && (!isSymbolFileKept || access(symbolName.c_str(), F_OK) == 0)) {
+            unit.diagnostics = resident->diagnostics;
+            unit.fingerprint = resident->fingerprint;
+            unit.isUpToDate = unit.diagnostics.empty();
+            return;
+        }
+        if (source == nullptr) {
+            source = SourceBuffer::FromFile(unit.fileName);
+            if (source == nullptr) {
+                unit.isUnreadable = true;
+                return;
+            }
+            sourceLength = source->GetLength();
+            sourceHash = HashContent(source->GetData(), sourceLength);
+        }
+        resident->sourceHash = sourceHash;
+        resident->sourceLength = sourceLength;
+        resident->importFingerprints = fingerprints;
+    }
+
+    if (isSymbolFileKept) {
+        auto record = BuildRecord::Load(BuildRecord::GetFileName(m_SymbolDirectory, unit.moduleName));
+        auto symbols = SymbolFile::Open(symbolName);
+        if (record != nullptr && record->Matches(sourceHash, sourceLength) && record->GetImports() == fingerprints
+            && symbols != nullptr && symbols->Matches(sourceHash, sourceLength)) {
+            unit.fingerprint = record->GetFingerprint();
+            unit.isUpToDate = true;
+            return;
+        }
+    }
+    else if (isCached) {
+        auto cache = ASTCache::Open(cacheName);
+        if (cache != nullptr && cache->Matches(sourceHash, sourceLength)) {
+            unit.isCacheHit = true;
+            return;
+        }
+    }
+
+    // Outputs that are not here, after a clean checkout or a branch switch, may be in the
+    // CompileCache from any earlier build. The module entry is the symbol file, or an empty entry
+    // saying the source compiled cleanly when no symbol files are kept.
+    std::string moduleKey, treeKey;
+    bool isShared = m_Cache != nullptr && !isStreaming;
+    if (isShared) {
+        moduleKey = CompileCache::MakeKey(isSymbolFileKept ? "module symbols" : "module", sourceHash, sourceLength, fingerprints);
+        if (isCached) treeKey = CompileCache::MakeKey("tree", sourceHash, sourceLength);
+        bool isRestored = m_Cache->Fetch(moduleKey, isSymbolFileKept ? "obxs" : "ok", isSymbolFileKept ? symbolName : std::string());
+        if (isRestored && isCached) isRestored = m_Cache->Fetch(treeKey, "obxc", cacheName);
+        if (isRestored && isSymbolFileKept) {
+            auto symbols = SymbolFile::Open(symbolName);
+            isRestored = symbols != nullptr && symbols->Matches(sourceHash, sourceLength) && saveRecord(unit, *symbols, sourceHash, sourceLength, fingerprints);
+            if (isRestored) unit.fingerprint = symbols->GetFingerprint();
+        }
+        if (isRestored) {
+            unit.isRestored = true;
+            return;
+        }
+    }
+
+    auto lexer = std::make_shared<Tokenizer>(source);
+    Parser parser(lexer);
+    if (m_IsRecovering) parser.EnableRecovery();
+    ASTNode* node = nullptr;
+    try {
+        node = parser.ParseOberon();
+    }
+    catch (const SyntaxError& error) {
+        unit.diagnostics.push_back(error);
+        return;
+    }
+    unit.diagnostics = parser.GetDiagnostics();
+    if (!unit.diagnostics.empty() || node == nullptr) return;
+
+    auto& names = *lexer->GetNames();
+    if (!m_SymbolDirectory.empty() && !isStreaming) checkImports(unit, node, names, *source);
+    if (!unit.diagnostics.empty()) return;
+    if (isCached && !ASTCache::Write(cacheName, node, names, sourceHash, sourceLength)) {
+        unit.isCacheUnwritable = true;
+    }
+    if (isSymbolFileKept) {
+        auto symbols = SymbolFile::Open(symbolName);
+        if (symbols == nullptr || !symbols->Matches(sourceHash, sourceLength)) {
+            symbols = SymbolFile::Write(symbolName, node, names, sourceHash, sourceLength) ? SymbolFile::Open(symbolName) : nullptr;
+        }
+        if (symbols == nullptr || !saveRecord(unit, *symbols, sourceHash, sourceLength, fingerprints)) unit.isSymbolsUnwritable = true;
+        else unit.fingerprint = symbols->GetFingerprint();
+    }
+
+    if (isShared && unit.importErrors.empty()) {
+        if (!isSymbolFileKept) m_Cache->Store(moduleKey, "ok", "");
+        else if (!unit.isSymbolsUnwritable) m_Cache->Store(moduleKey, "obxs", symbolName);
+        if (isCached && !unit.isCacheUnwritable) m_Cache->Store(treeKey, "obxc", cacheName);
+    }
+}
+
+bool CompileDriver::saveRecord(const CompileUnit& unit, const SymbolFile& symbols, unsigned long long sourceHash, unsigned long long sourceLength,
+                               const std::vector<std::pair<std::string, unsigned long long>>& fingerprints) const {
+    BuildRecord record(sourceHash, sourceLength, symbols.GetFingerprint());
+    record.SetImports(fingerprints);
+    return record.Save(BuildRecord::GetFileName(m_SymbolDirectory, unit.moduleName));
+}
+
+// The fingerprints the imports of a module have now. Those compiled in this Run are known, the others
+// come from their build records. Imports without a record are left out.
+std::vector<std::pair<std::string, unsigned long long>> CompileDriver::importFingerprints(size_t index) const {
+    auto& unit = m_Units[index];
+    auto& compiled = m_Graph->GetImports(index);
+    std::vector<std::pair<std::string, unsigned long long>> fingerprints;
+    for (auto& import : unit.imports) {
+        auto found = std::find_if(compiled.begin(), compiled.end(), [this, &import](size_t node) { return m_Units[node].moduleName == import; });
+        if (found != compiled.end() && m_Units[*found].fingerprint != 0) {
+            fingerprints.emplace_back(import, m_Units[*found].fingerprint);
+            continue;
+        }
+        auto record = BuildRecord::Load(BuildRecord::GetFileName(m_SymbolDirectory, import));
+        if (record != nullptr) fingerprints.emplace_back(import, record->GetFingerprint());
+    }
+    std::sort(fingerprints.begin(), fingerprints.end());
+    fingerprints.erase(std::unique(fingerprints.begin(), fingerprints.end()), fingerprints.end());
+    return fingerprints;
+}
+
+namespace {
+
+// Collects the qualidents of a tree whose first name is one of the module's imports.
+struct ImportUseVisitor : ASTVisitor {
+    const std::unordered_map<Atom, std::string>* aliases;
+    std::vector<ASTNode*> uses;
+
+    bool Enter(ASTNode* node) {
+        if (node->GetKind() == N_QUALIDENT && aliases->count(node->GetName(0)) != 0) uses.push_back(node);
+        return true;
+    }
+};
+
+}
+
+// Names taken from an import are looked up in its symbol file, mapped the first time the import is
+// used. Imports without a symbol file are not checked.
+void CompileDriver::checkImports(CompileUnit& unit, ASTNode* root, const NameTable& names, SourceBuffer& source) const {
+    std::unordered_map<Atom, std::string> aliases;
+    if (root->GetKind() == N_MODULE) {
+        for (auto list : root->GetList()) {
+            if (list->GetKind() != N_IMPORT_LIST) continue;
+            for (auto import : list->GetList()) {
+                switch (import->GetKind()) {
+                    case N_IMPORT:              aliases[import->GetName(0)] = names.GetName(import->GetName(0)); break;
+                    case N_IMPORT_PATH:         aliases[import->GetName(1)] = names.GetName(import->GetName(1)); break;
+                    case N_IMPORT_ASSIGN:       aliases[import->GetName(0)] = names.GetName(import->GetName(1)); break;
+                    case N_IMPORT_ASSIGN_PATH:  aliases[import->GetName(0)] = names.GetName(import->GetName(2)); break;
+                    default:                    break;
+                }
+            }
+        }
+    }
+    if (aliases.empty()) return;
+
+    ImportUseVisitor visitor;
+    visitor.aliases = &aliases;
+    ASTWalker walker;
+    walker.Walk(root, visitor);
+    std::stable_sort(visitor.uses.begin(), visitor.uses.end(), [](ASTNode* a, ASTNode* b) { return a->GetPosition() < b->GetPosition(); });
+
+    std::unordered_map<Atom, std::shared_ptr<SymbolFile>> imports;
+    for (auto use : visitor.uses) {
+        auto found = imports.find(use->GetName(0));
+        if (found == imports.end()) {
+            auto symbols = SymbolFile::Open(SymbolFile::GetFileName(m_SymbolDirectory, aliases[use->GetName(0)]));
+            found = imports.emplace(use->GetName(0), symbols).first;
+        }
+        if (found->second == nullptr || !found->second->Find(names.GetName(use->GetName(1))).IsNull()) continue;
+        auto& lines = source.GetLines();
+        unit.diagnostics.push_back(SyntaxError(lines.GetLine(use->GetPosition()), lines.GetColumn(use->GetPosition()),
+            "'" + std::string(names.GetName(use->GetName(1))) + "' is not exported by module '" + std::string(found->second->GetModuleName()) + "'!"));
+    }
+}
+
+void CompileDriver::Report(std::ostream& out) const {
+    for (auto& unit : m_Units) {
+        if (unit.isUnreadable) out << "Can't open source file '" << unit.fileName << "'!" << std::endl;
+        if (unit.isCacheUnwritable) out << "Can't write AST cache '" << unit.fileName << ".obxc'!" << std::endl;
+        if (unit.isSymbolsUnwritable) out << "Can't write symbol file of '" << unit.fileName << "'!" << std::endl;
+        for (auto error : unit.diagnostics) out << unit.fileName << ": " << error.GetExceptionDetails();
+        for (auto& error : unit.importErrors) out << unit.fileName << ": " << error << std::endl;
+    }
+}
+
+void CompileDriver::ReportSchedule(std::ostream& out) const {
+    std::vector<double> weights;
+    size_t skipped = 0, upToDate = 0;
+    double work = 0.0;
+    for (auto& unit : m_Units) {
+        weights.push_back(unit.seconds);
+        work += unit.seconds;
+        if (unit.isSkipped) skipped++;
+        if (unit.isUpToDate || unit.isCacheHit || unit.isRestored) upToDate++;
+    }
+    auto wall = m_Scheduler.GetWallSeconds();
+    std::vector<size_t> path;
+    auto critical = m_Graph != nullptr ? m_Graph->GetCriticalPath(weights, path) : 0.0;
+
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    out << "Modules: " << m_Units.size() << ", " << upToDate << " up to date, " << skipped << " not compiled, " << m_Cycles << " import cycles" << std::endl;
+    out << "Header scan: " << m_ScanSeconds * 1000.0 << " ms, compile: " << wall * 1000.0 << " ms wall, "
+        << work * 1000.0 << " ms work on " << GetWorkerCount() << " workers" << std::endl;
+    out << "Critical path: " << critical * 1000.0 << " ms over " << path.size() << " modules";
+    for (size_t i = 0; i < path.size(); i++) {
+        auto& unit = m_Units[path[i]];
+        out << (i == 0 ? ", " : " -> ") << (unit.moduleName.empty() ? unit.fileName : unit.moduleName);
+    }
+    out << std::endl;
+    if (m_Cache != nullptr) {
+        out << "Compile cache: " << m_Cache->GetHits() << " hits, " << m_Cache->GetMisses() << " misses, " << m_Cache->GetStores() << " stored, "
+            << m_Cache->GetEvictions() << " evicted";
+        if (m_Cache->IsMeasured()) out << ", " << m_Cache->GetBytes() / (1024.0 * 1024.0) << " MB";
+        out << std::endl;
+    }
+    auto& stats = m_Scheduler.GetStats();
+    for (size_t worker = 0; worker < stats.size(); worker++) {
+        out << "Worker " << worker << ": " << (wall > 0.0 ? 100.0 * stats[worker].busySeconds / wall : 0.0) << "% busy, "
+            << stats[worker].tasks << " modules, " << stats[worker].steals << " stolen" << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,125 @@
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "CompileCache.h"
+#include "ModuleGraph.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include "SymbolFile.h"
+#include "WorkScheduler.h"
+
+#pragma once
+
+// A file given to the CompileDriver and what compiling it gave.
+struct CompileUnit {
+    std::string fileName;
+    size_t size;                            // Bytes on disk, what is waiting on the largest files is started first
+    std::string moduleName;                 // From the header scan, empty if the header did not parse
+    std::vector<std::string> imports;       // Names of the modules imported
+    bool isUnreadable;
+    bool isSkipped;                         // Not compiled, it is in an import cycle or an import failed
+    bool isCacheHit;                        // The AST cache matched, the file was not parsed
+    bool isUpToDate;                        // Its BuildRecord matched the source and the imports, it was not compiled
+    bool isRestored;                        // Its outputs were taken from the CompileCache, it was not compiled
+    bool isUnchanged;                       // Resident only, same time and size as in the last Run, it was not read
+    bool isCacheUnwritable;
+    bool isSymbolsUnwritable;
+    std::vector<SyntaxError> diagnostics;
+    std::vector<std::string> importErrors;  // Cycles, duplicate module names and failed imports
+    unsigned long long fingerprint;         // Of its symbol file, 0 if it has none
+    unsigned int worker;                    // The thread that compiled it, and how long it took
+    double seconds;
+};
+
+// Compiles many files on a pool of worker threads. Every file gets its own SourceBuffer, NameTable,
+// TokenStream and ASTArena. A first pass parses only the header of each file, up to its leading
+// import lists, and the files are put in a ModuleGraph by module name. The WorkScheduler then starts
+// each module as soon as the modules it imports are compiled. Imports after the first declaration
+// are not seen by the header scan and do not order the build, and neither does standard input.
+// Results are kept per file and reported in the order the files were added, so the output does not
+// depend on which thread compiled what.
+class CompileDriver
+{
+    public:
+        // With workers 0 there is one thread per hardware thread.
+        CompileDriver(unsigned int workers = 0);
+
+        // A file, or every *.obx file below a directory in path order, '-' is standard input.
+        // Returns false if path does not exist.
+        bool AddInput(const std::string& path);
+        // Keep the tree of every file in <file>.obxc and skip files that did not change, see ASTCache.
+        void EnableCaching() { m_IsCaching = true; }
+        // Report all syntax errors of a file instead of the first, see Parser::EnableRecovery.
+        void EnableRecovery() { m_IsRecovering = true; }
+        // Write the SymbolFile and BuildRecord of every module compiled to directory, and check the
+        // names a module takes from its imports against their symbol files there. A module is only
+        // compiled if its source or the fingerprint of one of its imports changed since its record
+        // was written. Returns false if directory can't be made.
+        bool SetSymbolDirectory(const std::string& directory);
+        // Share the outputs of clean compiles through a CompileCache in directory, trimmed to
+        // maxBytes after every Run. Returns false if directory can't be made.
+        bool SetCacheDirectory(const std::string& directory, unsigned long long maxBytes);
+        // Remember every file between runs, for a driver that stays resident, see CompileServer. A file
+        // with the time and size it had in the last Run is not read again, its header and result are
+        // taken from memory. One that was touched but has the same content and import fingerprints
+        // is read and hashed, but not compiled.
+        void EnableResidentState() { m_IsResident = true; }
+        // Drops the files added and the results of the last Run, what is remembered is kept.
+        void ClearInputs();
+
+        // Compiles every file added. Returns the number of files that failed.
+        size_t Run();
+        // The diagnostics of all files, in input order.
+        void Report(std::ostream& out) const;
+        // How the last Run went: the critical path through the imports, the longest chain of
+        // modules that had to be compiled one after the other, and how busy each worker was.
+        void ReportSchedule(std::ostream& out) const;
+
+        const std::vector<CompileUnit>& GetUnits() const { return m_Units; }
+        unsigned int GetWorkerCount() const { return m_Scheduler.GetWorkerCount(); }
+
+    private:
+        void addFile(const std::string& fileName, size_t size);
+        void scan(size_t index);
+        void compile(size_t index);
+        void checkImports(CompileUnit& unit, ASTNode* root, const NameTable& names, SourceBuffer& source) const;
+        std::vector<std::pair<std::string, unsigned long long>> importFingerprints(size_t index) const;
+        bool saveRecord(const CompileUnit& unit, const SymbolFile& symbols, unsigned long long sourceHash, unsigned long long sourceLength,
+                        const std::vector<std::pair<std::string, unsigned long long>>& fingerprints) const;
+        static bool isFailed(const CompileUnit& unit);
+
+        // What a resident driver remembers of a file from the last Run that compiled it. The result
+        // is valid for a file of the same content compiled against the same import fingerprints.
+        struct ResidentFile {
+            std::filesystem::file_time_type time;
+            size_t size;
+            unsigned long long sourceHash;
+            unsigned long long sourceLength;
+            std::string moduleName;
+            std::vector<std::string> imports;
+            std::vector<std::pair<std::string, unsigned long long>> importFingerprints;
+            unsigned long long fingerprint;
+            std::vector<SyntaxError> diagnostics;
+            bool isValid;                       // False until a Run compiled it without import errors
+        };
+
+        std::vector<CompileUnit> m_Units;
+        std::vector<std::shared_ptr<SourceBuffer>> m_Sources;   // Opened by the scan, kept for the compile
+        std::unique_ptr<ModuleGraph> m_Graph;
+        size_t m_Cycles;
+        double m_ScanSeconds;
+        WorkScheduler m_Scheduler;
+        bool m_IsCaching;
+        bool m_IsRecovering;
+        std::string m_SymbolDirectory;          // Empty if no symbol files are kept
+        std::unique_ptr<CompileCache> m_Cache;
+        bool m_IsResident;
+        std::unordered_map<std::string, ResidentFile> m_Resident;   // By file name
+        std::vector<ResidentFile*> m_ResidentUnits;                 // Per unit of the Run, nullptr if not resident
+};
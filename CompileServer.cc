@@ -0,0 +1,180 @@
+#include "CompileServer.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+// Longer requests are not read, a build of that many inputs names directories instead.
+static const size_t MAX_REQUEST_SIZE = 16 * 1024 * 1024;
+// A client sends its request at once and reads the answer as it comes. One that stalls longer is
+// dropped, requests are served one at a time and it would hold up every other client.
+static const int CLIENT_TIMEOUT_SECONDS = 5;
+
+CompileServer::CompileServer(CompileDriver& driver, const std::string& socketName) : m_Driver(driver) {
+    m_SocketName = socketName;
+}
+
+int CompileServer::connectTo(const std::string& socketName) {
+    sockaddr_un address {};
+    if (socketName.size() >= sizeof(address.sun_path)) return -1;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socketName.data(), socketName.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// A peer that went away must not end the process with SIGPIPE.
+bool CompileServer::writeAll(int fd, const std::string& text) {
+    size_t done = 0;
+    while (done < text.size()) {
+        auto count = send(fd, text.data() + done, text.size() - done, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        done += count;
+    }
+    return true;
+}
+
+bool CompileServer::Run() {
+    sockaddr_un address {};
+    if (m_SocketName.size() >= sizeof(address.sun_path)) return false;
+    int running = connectTo(m_SocketName);
+    if (running >= 0) {
+        close(running);
+        return false;
+    }
+    /* Only a socket is ours to replace, a mistyped path must not delete a file */
+    struct stat status;
+    if (lstat(m_SocketName.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) return false;
+        unlink(m_SocketName.c_str());
+    }
+
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, m_SocketName.data(), m_SocketName.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return false;
+    }
+
+    bool isStopped = false;
+    while (!isStopped) {
+        int client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        timeval timeout { CLIENT_TIMEOUT_SECONDS, 0 };
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        isStopped = serve(client);
+        close(client);
+    }
+    close(fd);
+    unlink(m_SocketName.c_str());
+    return true;
+}
+
+// Returns true if the request was to stop.
+bool CompileServer::serve(int client) {
+    std::string request;
+    char buffer[4096];
+    while (request.find("\n\n") == std::string::npos && request.size() < MAX_REQUEST_SIZE) {
+        auto count = read(client, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        request.append(buffer, count);
+    }
+
+    std::istringstream lines(request);
+    std::string line;
+    std::getline(lines, line);
+    if (line == "stop") {
+        writeAll(client, "exit 0\n");
+        return true;
+    }
+    if (line != "OBX " + std::to_string(VERSION)) {
+        writeAll(client, "Not a request of version " + std::to_string(VERSION) + "!\nexit 1\n");
+        return false;
+    }
+
+    std::ostringstream out;
+    bool isScheduleShown = false, isComplete = false, isAdded = true;
+    m_Driver.ClearInputs();
+    while (std::getline(lines, line)) {
+        if (line.empty()) {
+            isComplete = true;
+            break;
+        }
+        if (line == "schedule") isScheduleShown = true;
+        else if (line.compare(0, 6, "input ") == 0 && !m_Driver.AddInput(line.substr(6))) {
+            out << "Can't open source file '" << line.substr(6) << "'!" << std::endl;
+            isAdded = false;
+        }
+    }
+    if (!isComplete) {
+        writeAll(client, "Request not complete!\nexit 1\n");
+        return false;
+    }
+    if (!isAdded) {
+        writeAll(client, out.str() + "exit 1\n");
+        return false;
+    }
+
+    auto failed = m_Driver.Run();
+    m_Driver.Report(out);
+    if (isScheduleShown) m_Driver.ReportSchedule(out);
+    out << "exit " << (failed == 0 ? 0 : 1) << "\n";
+    writeAll(client, out.str());
+    return false;
+}
+
+// The answer is read to the end, the server closes the connection after the exit line.
+int CompileServer::exchange(int fd, const std::string& request, std::ostream& out) {
+    std::string answer;
+    char buffer[4096];
+    bool isSent = writeAll(fd, request);
+    while (isSent) {
+        auto count = read(fd, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        answer.append(buffer, count);
+    }
+    close(fd);
+
+    auto last = answer.empty() ? std::string::npos : answer.rfind("exit ", answer.size() - 1);
+    if (!isSent || last == std::string::npos || (last != 0 && answer[last - 1] != '\n')) return -1;
+    out << answer.substr(0, last);
+    return std::atoi(answer.c_str() + last + 5);
+}
+
+int CompileServer::Send(const std::string& socketName, const std::vector<std::string>& inputs, bool isScheduleShown, std::ostream& out) {
+    int fd = connectTo(socketName);
+    if (fd < 0) return -1;
+    std::string request = "OBX " + std::to_string(VERSION) + "\n";
+    if (isScheduleShown) request += "schedule\n";
+    for (auto& input : inputs) request += "input " + input + "\n";
+    request += "\n";
+    return exchange(fd, request, out);
+}
+
+bool CompileServer::Stop(const std::string& socketName) {
+    int fd = connectTo(socketName);
+    if (fd < 0) return false;
+    std::ostringstream out;
+    return exchange(fd, "stop\n\n", out) == 0;
+}
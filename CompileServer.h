@@ -0,0 +1,46 @@
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "CompileDriver.h"
+
+#pragma once
+
+// Keeps a CompileDriver resident behind a Unix domain socket. A build sent to it pays for no
+// process start, and the files it compiled before are found in memory: their headers, so the
+// import graph is not scanned again, their results and the fingerprints of their interfaces, see
+// CompileDriver::EnableResidentState. A file is read again only when its time or size changed, and
+// compiled again only when its content or the interfaces it imports did. Requests are served one
+// at a time, each on all the workers of the driver, with the options the server was started with.
+//
+// The protocol is lines of text. A request is a "OBX <version>" line, a "schedule" line if the
+// schedule is wanted, one "input <path>" line per file or directory and an empty line. Paths are
+// absolute, the server does not share the working directory of the client. A request of a "stop"
+// line ends the server. The answer is the report of the build followed by an "exit <status>" line.
+class CompileServer
+{
+    public:
+        static const unsigned int VERSION = 1;
+
+        CompileServer(CompileDriver& driver, const std::string& socketName);
+
+        // Serves requests until one says stop. Returns false if the socket can't be made or another
+        // server already listens on it. A socket left behind by a server that died is replaced, any other
+        // file on the path is left alone and the server does not start.
+        bool Run();
+
+        // Client side. Sends the inputs to the server at socketName, writes the report it answers to
+        // out and returns the exit status of the build, -1 if no server answered.
+        static int Send(const std::string& socketName, const std::vector<std::string>& inputs, bool isScheduleShown, std::ostream& out);
+        // Asks the server at socketName to end. Returns false if no server answered.
+        static bool Stop(const std::string& socketName);
+
+    private:
+        bool serve(int client);
+        static int connectTo(const std::string& socketName);
+        static bool writeAll(int fd, const std::string& text);
+        static int exchange(int fd, const std::string& request, std::ostream& out);
+
+        CompileDriver& m_Driver;
+        std::string m_SocketName;
+};
@@ -0,0 +1,56 @@
+#include "ContentHash.h"
+
+#include <cstring>
+
+static const unsigned long long PRIME1 = 0x9E3779B185EBCA87ull;
+static const unsigned long long PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static const unsigned long long PRIME3 = 0x165667B19E3779F9ull;
+
+static inline unsigned long long rotl(unsigned long long x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static inline unsigned long long load64(const unsigned char* p) {
+    unsigned long long v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline unsigned long long hashRound(unsigned long long acc, unsigned long long input) {
+    return rotl(acc + input * PRIME2, 31) * PRIME1;
+}
+
+// splitmix64 finalizer, every input bit affects every output bit.
+static inline unsigned long long mix(unsigned long long h) {
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+unsigned long long HashContent(const void* data, size_t length, unsigned long long seed) {
+    auto p = static_cast<const unsigned char*>(data);
+    auto end = p + length;
+    unsigned long long h;
+
+    if (length >= 32) {
+        unsigned long long v1 = seed + PRIME1 + PRIME2, v2 = seed + PRIME2, v3 = seed, v4 = seed - PRIME1;
+        for ( ; end - p >= 32; p += 32) {
+            v1 = hashRound(v1, load64(p));
+            v2 = hashRound(v2, load64(p + 8));
+            v3 = hashRound(v3, load64(p + 16));
+            v4 = hashRound(v4, load64(p + 24));
+        }
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    }
+    else h = seed + PRIME3;
+
+    h += length;
+    for ( ; end - p >= 8; p += 8) h = rotl(h ^ hashRound(0, load64(p)), 27) * PRIME1 + PRIME3;
+    for ( ; p < end; p++) h = rotl(h ^ (*p * PRIME3), 11) * PRIME1;
+    return mix(h);
+}
+
+std::string FormatHash(unsigned long long hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; i--, hash >>= 4) text[i] = digits[hash & 15];
+    return text;
+}
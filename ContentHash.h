@@ -0,0 +1,11 @@
+#include <cstddef>
+#include <string>
+
+#pragma once
+
+// 64 bit hash of a byte range for change detection, not for security. Four independent lanes of
+// multiply and rotate over 32 byte blocks, a few GB/s on large files.
+unsigned long long HashContent(const void* data, size_t length, unsigned long long seed = 0);
+
+// 16 lower case hex digits.
+std::string FormatHash(unsigned long long hash);
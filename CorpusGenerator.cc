@@ -0,0 +1,266 @@
+#include "CorpusGenerator.h"
+
+const CorpusProfile CORPUS_PROFILES[] = {
+    // name             decl  proc  comment  string  depth  length  run
+    { "mixed",            3,    5,     2,      1,      3,     12,    0 },
+    { "declarations",    10,    1,     1,      0,      1,      4,    0 },
+    { "expressions",      1,    6,     0,      0,      8,      8,    0 },
+    { "comments",         1,    2,    10,      0,      2,      4,    0 },
+    { "procedures",       1,   10,     1,      0,      3,     60,    0 },
+    { "strings",          1,    1,     1,     10,      1,      4,    0 },
+    { "dsp",              1,   10,     0,      0,      2,     16,    3 }
+};
+
+const size_t CORPUS_PROFILE_COUNT = sizeof(CORPUS_PROFILES) / sizeof(CORPUS_PROFILES[0]);
+
+const CorpusProfile* FindCorpusProfile(const std::string& name) {
+    for (size_t i = 0; i < CORPUS_PROFILE_COUNT; i++) {
+        if (name == CORPUS_PROFILES[i].name) return &CORPUS_PROFILES[i];
+    }
+    return nullptr;
+}
+
+static const char* docLines[] = {
+    "Computes the next state of the filter bank, coefficients are expected in Q15 format.",
+    "The caller owns the list, nodes are never freed here and may be shared between lists.",
+    "Returns FALSE if the buffer is too small, the contents of the buffer are then undefined.",
+    "Not reentrant: the scratch table is module global and reused by every call."
+};
+
+static const char* messages[] = {
+    "The file could not be saved because the disk is full. Free some space and try again.",
+    "Die Datei konnte nicht gespeichert werden, weil der Datenträger voll ist.",
+    "Не удалось сохранить файл, так как диск заполнен.",
+    "ディスクがいっぱいのため、ファイルを保存できませんでした。"
+};
+
+CorpusGenerator::CorpusGenerator(const CorpusProfile& profile, unsigned long long seed) {
+    m_Profile = profile;
+    m_State = seed;
+    m_Serial = 0;
+}
+
+std::string CorpusGenerator::Generate(size_t targetSize) {
+    m_Text.clear();
+    m_Text.reserve(targetSize + 4096);
+    m_Text += "MODULE Corpus;\nIMPORT Out, Sys := System.Core;\n";
+    unsigned int total = m_Profile.declarationWeight + m_Profile.procedureWeight + m_Profile.commentWeight + m_Profile.stringWeight;
+    while (m_Text.size() < targetSize) {
+        unsigned int pick = next(total);
+        if (pick < m_Profile.declarationWeight) emitDeclarations();
+        else if ((pick -= m_Profile.declarationWeight) < m_Profile.procedureWeight) emitProcedure();
+        else if ((pick -= m_Profile.procedureWeight) < m_Profile.commentWeight) emitComment();
+        else emitStrings();
+    }
+    m_Text += "BEGIN\n    Out.Ln\nEND Corpus.\n";
+    return std::move(m_Text);
+}
+
+// splitmix64, small and the same on every platform.
+unsigned int CorpusGenerator::next(unsigned int bound) {
+    unsigned long long z = (m_State += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return static_cast<unsigned int>(z % bound);
+}
+
+std::string CorpusGenerator::name(const char* prefix, unsigned int range) {
+    return prefix + std::to_string(next(range));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Declarations ///////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CorpusGenerator::emitDeclarations() {
+    auto serial = std::to_string(m_Serial++);
+    m_Text += "CONST\n";
+    for (unsigned int i = 0, n = 2 + next(4); i < n; i++) {
+        m_Text += "    " + name("limit", 64) + serial + "* = ";
+        emitExpression(1);
+        m_Text += ";\n";
+    }
+    m_Text += "TYPE\n";
+    m_Text += "    Node" + serial + "* = POINTER TO NodeDesc" + serial + ";\n";
+    m_Text += "    NodeDesc" + serial + "* = RECORD next: Node" + serial + "; key, value: INTEGER; name: ARRAY [32] OF CHAR END;\n";
+    m_Text += "    Table" + serial + " = ARRAY [" + std::to_string(16 + next(240)) + "] OF Node" + serial + ";\n";
+    m_Text += "VAR\n";
+    for (unsigned int i = 0, n = 1 + next(4); i < n; i++) {
+        m_Text += "    " + name("g", 512) + "_" + serial + ", " + name("h", 512) + "_" + serial + ": " + (chance(50) ? "INTEGER" : "Node" + serial) + ";\n";
+    }
+}
+
+void CorpusGenerator::emitComment() {
+    m_Text += "(* ";
+    for (unsigned int i = 0, n = 1 + next(12); i < n; i++) {
+        m_Text += docLines[next(4)];
+        m_Text += "\n   ";
+    }
+    m_Text += "*)\n";
+}
+
+void CorpusGenerator::emitStrings() {
+    auto serial = std::to_string(m_Serial++);
+    m_Text += "CONST\n";
+    for (unsigned int i = 0, n = 8 + next(32); i < n; i++) {
+        m_Text += "    Msg" + serial + "_" + std::to_string(i) + "* = \"" + messages[next(4)] + "\";\n";
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Procedures and statements //////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CorpusGenerator::emitProcedure() {
+    auto procName = "Proc" + std::to_string(m_Serial++);
+    m_Text += "PROCEDURE " + procName + "*(VAR list: Node; key, limit: INTEGER);\n";
+    m_Text += "    VAR p, q: Node; i, sum, count: INTEGER;\nBEGIN\n";
+    emitStatementSequence(m_Profile.procedureLength, 0, 4);
+    m_Text += "\nEND " + procName + ";\n\n";
+}
+
+void CorpusGenerator::emitStatementSequence(unsigned int count, unsigned int nesting, unsigned int indent) {
+    for (unsigned int i = 0; i < count; i++) {
+        if (i > 0) m_Text += ";\n";
+        m_Text.append(indent, ' ');
+        emitStatement(nesting, indent);
+    }
+}
+
+void CorpusGenerator::emitStatement(unsigned int nesting, unsigned int indent) {
+    unsigned int kind = nesting < 3 ? next(10) : next(3);
+    std::string inner(indent, ' ');
+    switch (kind) {
+        case 0:
+        case 1:
+            m_Text += name("v", 16) + " := ";
+            emitExpression(m_Profile.expressionDepth);
+            break;
+        case 2:
+            m_Text += "Out.Int(" + name("v", 16) + ")";
+            break;
+        case 3:
+            m_Text += "IF ";
+            emitCondition();
+            m_Text += " THEN\n";
+            emitStatementSequence(1 + next(3), nesting + 1, indent + 4);
+            if (chance(40)) {
+                m_Text += "\n" + inner + "ELSIF ";
+                emitCondition();
+                m_Text += " THEN\n";
+                emitStatementSequence(1 + next(2), nesting + 1, indent + 4);
+            }
+            if (chance(50)) {
+                m_Text += "\n" + inner + "ELSE\n";
+                emitStatementSequence(1 + next(2), nesting + 1, indent + 4);
+            }
+            m_Text += "\n" + inner + "END";
+            break;
+        case 4:
+            m_Text += "WHILE ";
+            emitCondition();
+            m_Text += " DO\n";
+            emitStatementSequence(1 + next(3), nesting + 1, indent + 4);
+            m_Text += "\n" + inner + "END";
+            break;
+        case 5:
+            m_Text += "REPEAT\n";
+            emitStatementSequence(1 + next(3), nesting + 1, indent + 4);
+            m_Text += "\n" + inner + "UNTIL ";
+            emitCondition();
+            break;
+        case 6:
+            m_Text += "FOR i := " + std::to_string(next(4)) + " TO " + name("limit", 64) + " BY " + std::to_string(1 + next(3)) + " DO\n";
+            emitStatementSequence(1 + next(3), nesting + 1, indent + 4);
+            m_Text += "\n" + inner + "END";
+            break;
+        case 7:
+            m_Text += "CASE " + name("v", 16) + " OF\n";
+            for (unsigned int i = 0, n = 2 + next(3); i < n; i++) {
+                m_Text += inner + (i == 0 ? "  " : "| ") + std::to_string(i * 4) + ".." + std::to_string(i * 4 + 3) + ": ";
+                emitStatement(3, indent + 4);
+                m_Text += "\n";
+            }
+            m_Text += inner + "ELSE\n";
+            emitStatementSequence(1, nesting + 1, indent + 4);
+            m_Text += "\n" + inner + "END";
+            break;
+        case 8:
+            m_Text += "LOOP\n";
+            emitStatementSequence(1 + next(2), nesting + 1, indent + 4);
+            m_Text += ";\n" + inner + "    IF ";
+            emitCondition();
+            m_Text += " THEN EXIT END\n" + inner + "END";
+            break;
+        default:
+            m_Text += "p := p.next; " + name("list", 4) + "[" + name("i", 4) + "] := p^.value";
+            break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Expressions ////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// With an operator run, a second relation in parentheses is joined to the first by '&'.
+void CorpusGenerator::emitCondition() {
+    static const char* relations[] = { " < ", " <= ", " = ", " >= ", " > ", " # " };
+    bool isJoined = m_Profile.operatorRun > 0 && chance(50);
+    if (isJoined) m_Text += "(";
+    emitExpression(1);
+    m_Text += relations[next(6)];
+    emitExpression(1);
+    if (isJoined) {
+        m_Text += ") & (";
+        emitExpression(1);
+        m_Text += relations[next(6)];
+        emitExpression(1);
+        m_Text += ")";
+    }
+}
+
+// Number of operators after the first operand. A profile without an operator run draws nothing more
+// from the generator, so its text stays the same.
+unsigned int CorpusGenerator::operatorCount() {
+    return next(3) + (m_Profile.operatorRun > 0 ? next(m_Profile.operatorRun + 1) : 0);
+}
+
+// SimpleExpression. Call arguments are single names, the parser reads 'f(x)' as a type guard.
+void CorpusGenerator::emitExpression(unsigned int depth) {
+    static const char* operators[] = { " + ", " - ", " OR " };
+    if (chance(10)) m_Text += "-";
+    emitTerm(depth);
+    for (unsigned int i = 0, n = operatorCount(); i < n; i++) {
+        m_Text += operators[next(3)];
+        emitTerm(depth);
+    }
+}
+
+void CorpusGenerator::emitTerm(unsigned int depth) {
+    static const char* operators[] = { " * ", " DIV ", " MOD ", " / " };
+    emitFactor(depth);
+    for (unsigned int i = 0, n = operatorCount(); i < n; i++) {
+        m_Text += operators[next(4)];
+        emitFactor(depth);
+    }
+}
+
+void CorpusGenerator::emitFactor(unsigned int depth) {
+    if (depth > 0 && chance(45)) {
+        m_Text += "(";
+        emitExpression(depth - 1);
+        m_Text += ")";
+        return;
+    }
+    switch (next(8)) {
+        case 0:     m_Text += std::to_string(next(100000)); break;
+        case 1:     m_Text += std::to_string(next(1000)) + "." + std::to_string(next(100)) + "E" + std::to_string(next(10)); break;
+        case 2:     m_Text += "0" + std::to_string(next(10)) + "AH"; break;
+        case 3:     m_Text += name("p", 4) + ".value"; break;
+        case 4:     m_Text += name("table", 8) + "[" + name("i", 4) + "]"; break;
+        case 5:     m_Text += "Sys.Abs(" + name("v", 16) + ")"; break;
+        case 6:     m_Text += "~" + name("flag", 8); break;
+        default:    m_Text += name("v", 16); break;
+    }
+}
@@ -0,0 +1,56 @@
+#include <cstddef>
+#include <string>
+
+#pragma once
+
+// Mix of constructs in a generated module. Weights are relative to each other, a zero weight
+// leaves the construct out.
+struct CorpusProfile {
+    const char* name;
+    unsigned int declarationWeight;     // CONST, TYPE and VAR sections
+    unsigned int procedureWeight;       // Procedures with statement bodies
+    unsigned int commentWeight;         // '(* ... *)' doc comments
+    unsigned int stringWeight;          // CONST sections of string literals
+    unsigned int expressionDepth;       // How deep expressions nest through parentheses
+    unsigned int procedureLength;       // Statements in a procedure body
+    unsigned int operatorRun;           // Extra operators per expression and term, conditions joined by '&'
+};
+
+extern const CorpusProfile CORPUS_PROFILES[];
+extern const size_t CORPUS_PROFILE_COUNT;
+
+// Returns nullptr for an unknown name.
+const CorpusProfile* FindCorpusProfile(const std::string& name);
+
+// Emits syntactically valid OberonX modules for benchmarking. The output depends only on the
+// profile, the seed and the target size, so runs on different commits lex and parse the same text.
+class CorpusGenerator
+{
+    public:
+        CorpusGenerator(const CorpusProfile& profile, unsigned long long seed);
+
+        // A single module of about targetSize bytes.
+        std::string Generate(size_t targetSize);
+
+    private:
+        unsigned int next(unsigned int bound);
+        bool chance(unsigned int percent) { return next(100) < percent; }
+        std::string name(const char* prefix, unsigned int range);
+
+        void emitDeclarations();
+        void emitProcedure();
+        void emitComment();
+        void emitStrings();
+        void emitStatementSequence(unsigned int count, unsigned int nesting, unsigned int indent);
+        void emitStatement(unsigned int nesting, unsigned int indent);
+        void emitCondition();
+        unsigned int operatorCount();
+        void emitExpression(unsigned int depth);
+        void emitTerm(unsigned int depth);
+        void emitFactor(unsigned int depth);
+
+        CorpusProfile m_Profile;
+        unsigned long long m_State;
+        unsigned int m_Serial;      // Makes type and procedure names unique
+        std::string m_Text;
+};
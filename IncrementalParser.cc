@@ -0,0 +1,144 @@
+#include "IncrementalParser.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Parser.h"
+#include "Tokenizer.h"
+#include "TokenStream.h"
+
+IncrementalParser::IncrementalParser(std::shared_ptr<SourceBuffer> source) {
+    m_Names = std::make_shared<NameTable>();
+    parseAll(source);
+}
+
+ASTNode* IncrementalParser::Apply(const std::vector<TextEdit>& edits) {
+    if (edits.empty()) return m_Tree;
+    std::vector<const TextEdit*> sorted;
+    for (auto& edit : edits) sorted.push_back(&edit);
+    std::sort(sorted.begin(), sorted.end(), [](const TextEdit* a, const TextEdit* b) { return a->offset < b->offset; });
+
+    auto old = m_Source->GetData();
+    std::string text;
+    size_t at = 0, inserted = 0;
+    for (auto edit : sorted) inserted += edit->text.size();
+    text.reserve(m_Source->GetLength() + inserted);
+    unsigned int delta = 0;                 // Length change, modulo 2^32 like the positions it is added to
+    for (auto edit : sorted) {
+        if (edit->offset < at || edit->offset + static_cast<size_t>(edit->length) > m_Source->GetLength()) {
+            throw std::invalid_argument("Text edits overlap or reach past the end of the text");
+        }
+        text.append(old + at, edit->offset - at);
+        text += edit->text;
+        at = edit->offset + edit->length;
+        delta += static_cast<unsigned int>(edit->text.size()) - edit->length;
+    }
+    text.append(old + at, m_Source->GetLength() - at);
+    auto source = SourceBuffer::FromString(std::move(text));
+    unsigned int start = sorted.front()->offset;
+    unsigned int end = sorted.back()->offset + sorted.back()->length;
+
+    if (m_Tree != nullptr && 2 * m_Garbage <= m_Arena->GetBytesUsed()) {
+        std::vector<Region> regions;
+        findRegions(start, regions);
+        for (auto region = regions.rbegin(); region != regions.rend(); ++region) {
+            unsigned int oldEnd = 0, newEnd = 0;
+            TokenCode oldFirst, newFirst;
+            ASTNode* node = nullptr;
+            auto used = m_Arena->GetBytesUsed();
+            try {
+                parseItem(m_Source, std::make_shared<ASTArena>(), *region, oldFirst, oldEnd);
+                if (end > oldEnd) continue;     // The edit reaches past this item
+                node = parseItem(source, m_Arena, *region, newFirst, newEnd);
+            }
+            catch (const SyntaxError&) { continue; }
+            // The list loop chose the rule by the first token, and the tokens behind the item must be the old ones
+            if (newFirst != oldFirst || newEnd != oldEnd + delta) continue;
+
+            auto& slot = region->owner->lists()[region->list][region->index];
+            m_ReparsedKind = slot->GetKind();
+            m_ReparsedLength = newEnd - slot->GetPosition();
+            slot = node;
+            shift(m_Tree, oldEnd, delta, node);
+            m_Garbage += m_Arena->GetBytesUsed() - used;
+            m_Source = source;
+            return m_Tree;
+        }
+    }
+
+    parseAll(source);
+    return m_Tree;
+}
+
+// A new arena drops the garbage of earlier edits. Nothing is changed if the source does not parse.
+void IncrementalParser::parseAll(std::shared_ptr<SourceBuffer> source) {
+    auto tokens = std::make_shared<TokenStream>(std::make_shared<Tokenizer>(source, m_Names));
+    tokens->InternStrings();
+    auto arena = std::make_shared<ASTArena>();
+    Parser parser(tokens, arena);
+    m_Tree = parser.ParseOberon();
+    m_Source = source;
+    m_Arena = arena;
+    m_Garbage = 0;
+    m_ReparsedKind = N_KIND_COUNT;
+    m_ReparsedLength = static_cast<unsigned int>(source->GetLength());
+}
+
+// Parses the item of region from its position in source. first is set to the kind of its first token,
+// end to the offset of the token behind it.
+ASTNode* IncrementalParser::parseItem(const std::shared_ptr<SourceBuffer>& source, std::shared_ptr<ASTArena> arena, const Region& region,
+                                      TokenCode& first, unsigned int& end) {
+    auto item = region.owner->GetList(region.list)[region.index];
+    auto lexer = std::make_shared<Tokenizer>(source, m_Names);
+    lexer->Seek(item->GetPosition());
+    auto tokens = std::make_shared<TokenStream>(lexer);
+    tokens->InternStrings();
+    first = tokens->PeekSymbol(1);
+    Parser parser(tokens, arena);
+    auto node = parser.ParseListItem(region.owner->GetKind(), item->GetKind());
+    end = tokens->GetOffset();
+    return node;
+}
+
+// Collects the list items that may hold offset, outermost first. Going down from the root it takes
+// the child that starts last before offset, list items are in source order and are searched by
+// halving. An item that starts at offset is not taken, the token in front of it may change.
+void IncrementalParser::findRegions(unsigned int offset, std::vector<Region>& regions) {
+    auto node = m_Tree;
+    while (node != nullptr) {
+        ASTNode* next = nullptr;
+        Region region = { nullptr, 0, 0 };
+        for (unsigned int i = 0; i < node->GetChildCount(); i++) {
+            auto child = node->GetChild(i);
+            if (child != nullptr && child->GetPosition() < offset && (next == nullptr || child->GetPosition() >= next->GetPosition())) next = child;
+        }
+        bool isOwner = node->GetKind() == N_MODULE || node->GetKind() == N_DECLARATION_SEQUENCE || node->GetKind() == N_STATEMENT_SEQUENCE;
+        for (unsigned int i = 0; i < node->GetListCount(); i++) {
+            auto list = node->GetList(i);
+            auto after = std::partition_point(list.begin(), list.end(), [offset](ASTNode* item) { return item->GetPosition() < offset; });
+            if (after == list.begin()) continue;
+            auto child = *(after - 1);
+            if (next == nullptr || child->GetPosition() >= next->GetPosition()) {
+                next = child;
+                region = { isOwner ? node : nullptr, i, static_cast<unsigned int>(after - 1 - list.begin()) };
+            }
+        }
+        if (region.owner != nullptr) regions.push_back(region);
+        node = next;
+    }
+}
+
+// Adds delta to the positions at or behind from, skip is the new item that has its positions
+// already. Only the last list item starting before from can hold such nodes, the ones before it end
+// where the next one starts.
+void IncrementalParser::shift(ASTNode* node, unsigned int from, unsigned int delta, const ASTNode* skip) {
+    if (node == nullptr || node == skip) return;
+    if (node->m_Pos >= from) node->m_Pos += delta;
+    for (unsigned int i = 0; i < node->GetChildCount(); i++) shift(node->GetChild(i), from, delta, skip);
+    for (unsigned int i = 0; i < node->GetListCount(); i++) {
+        auto list = node->GetList(i);
+        auto first = std::partition_point(list.begin(), list.end(), [from](ASTNode* item) { return item->m_Pos < from; });
+        if (first != list.begin()) first--;
+        for ( ; first != list.end(); ++first) shift(*first, from, delta, skip);
+    }
+}
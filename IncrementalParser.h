@@ -0,0 +1,75 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ASTArena.h"
+#include "ASTNode.h"
+#include "NameTable.h"
+#include "SourceBuffer.h"
+#include "Tokenizer.h"
+
+#pragma once
+
+// Replacement of length bytes at offset of the previous text by text.
+struct TextEdit {
+    unsigned int offset;
+    unsigned int length;
+    std::string text;
+};
+
+// Keeps the tree of a source file up to date while the file is edited. An edit re-lexes and
+// re-parses only the smallest list item around it: a statement of a StatementSequence, a
+// declaration of a DeclarationSequence, or an import list or declaration sequence of the module.
+// The new item replaces the old one in its list, every other node of the tree is kept and the
+// ones behind the edit have their positions moved.
+//
+// An item can be re-parsed on its own when the parse of the old item ended at or behind the edit
+// and the parse of the new item ends where the old one did, moved by the edit. Everything behind
+// that point is the same text and the same tokens, so the tree a full parse would build differs
+// only in that item. If no item qualifies the whole file is parsed again.
+//
+// String literals are interned in the NameTable, so the tree never views a text and the previous
+// text is dropped after an edit. Replaced items stay in the arena until they take up half of it,
+// the next edit then parses in full into a new arena.
+class IncrementalParser
+{
+    public:
+        // Parses source in full, throws SyntaxError like Parser::ParseOberon.
+        IncrementalParser(std::shared_ptr<SourceBuffer> source);
+
+        // Applies edits to the text and brings the tree up to date. Offsets are into the previous
+        // text, the edits may come in any order but must not overlap. Throws SyntaxError if the new
+        // text does not parse, the previous text and tree are kept then.
+        ASTNode* Apply(const std::vector<TextEdit>& edits);
+
+        ASTNode* GetTree() const { return m_Tree; }
+        std::shared_ptr<SourceBuffer> GetSource() const { return m_Source; }
+        std::shared_ptr<NameTable> GetNames() const { return m_Names; }
+        std::shared_ptr<ASTArena> GetArena() const { return m_Arena; }
+        // Kind of the item the last Apply re-parsed, N_KIND_COUNT if it parsed the whole file, and
+        // the length of its new text.
+        NodeKind GetReparsedKind() const { return m_ReparsedKind; }
+        unsigned int GetReparsedLength() const { return m_ReparsedLength; }
+
+    private:
+        // Item index of list of owner.
+        struct Region {
+            ASTNode* owner;
+            unsigned int list;
+            unsigned int index;
+        };
+
+        void parseAll(std::shared_ptr<SourceBuffer> source);
+        ASTNode* parseItem(const std::shared_ptr<SourceBuffer>& source, std::shared_ptr<ASTArena> arena, const Region& region,
+                           TokenCode& first, unsigned int& end);
+        void findRegions(unsigned int offset, std::vector<Region>& regions);
+        void shift(ASTNode* node, unsigned int from, unsigned int delta, const ASTNode* skip);
+
+        std::shared_ptr<SourceBuffer> m_Source;
+        std::shared_ptr<NameTable> m_Names;
+        std::shared_ptr<ASTArena> m_Arena;
+        ASTNode* m_Tree;
+        size_t m_Garbage;                       // Bytes of m_Arena taken by replaced items
+        NodeKind m_ReparsedKind;
+        unsigned int m_ReparsedLength;
+};
@@ -0,0 +1,41 @@
+#include "LineIndex.h"
+#include "CharScan.h"
+
+#include <algorithm>
+
+LineIndex::LineIndex() {
+    m_LineStarts.push_back(0);
+    m_IsAfterCR = false;
+}
+
+LineIndex::LineIndex(const char* data, size_t length) : LineIndex() {
+    m_LineStarts.reserve(length / 32 + 1);
+    Append(data, length, 0);
+}
+
+void LineIndex::Append(const char* data, size_t length, unsigned int base) {
+    if (length == 0) return;
+    const char* end = data + length;
+    const char* p = data;
+    if (m_IsAfterCR && *p == '\n') {
+        m_LineStarts.back() = base + 1;     /* '\r' '\n' split over two blocks */
+        p++;
+    }
+    m_IsAfterCR = false;
+    for (p = ScanLineBreak(p, end); p < end; p = ScanLineBreak(p, end)) {
+        if (*p == '\r') {
+            if (p + 1 == end) m_IsAfterCR = true;
+            else if (p[1] == '\n') p++;
+        }
+        p++;
+        m_LineStarts.push_back(base + (p - data));
+    }
+}
+
+unsigned int LineIndex::GetLine(unsigned int offset) const {
+    return std::upper_bound(m_LineStarts.begin(), m_LineStarts.end(), offset) - m_LineStarts.begin();
+}
+
+unsigned int LineIndex::GetColumn(unsigned int offset) const {
+    return offset - m_LineStarts[GetLine(offset) - 1] + 1;
+}
@@ -0,0 +1,26 @@
+#include <cstddef>
+#include <vector>
+
+#pragma once
+
+// Start offset of every line of a source text, built once with a vectorized newline search.
+// Tokens and nodes only carry byte offsets, line and column are looked up here when a
+// diagnostic needs them. '\r\n', '\n' and a lone '\r' all end a line.
+class LineIndex
+{
+    public:
+        LineIndex();
+        LineIndex(const char* data, size_t length);
+
+        // Adds the next block of a text that arrives in pieces, base is the offset of data in the whole text.
+        void Append(const char* data, size_t length, unsigned int base);
+
+        // Both are 1 based, the column counts bytes from the start of the line.
+        unsigned int GetLine(unsigned int offset) const;
+        unsigned int GetColumn(unsigned int offset) const;
+        size_t GetLineCount() const { return m_LineStarts.size(); }
+
+    private:
+        std::vector<unsigned int> m_LineStarts;
+        bool m_IsAfterCR;       // Last block ended in '\r', a '\n' starting the next one belongs to it
+};
@@ -0,0 +1,161 @@
+#include "ModuleGraph.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+static const size_t NONE = static_cast<size_t>(-1);
+
+ModuleGraph::ModuleGraph(const std::vector<std::string>& names, const std::vector<std::vector<std::string>>& imports) {
+    m_Imports.resize(names.size());
+    m_Importers.resize(names.size());
+    m_Duplicates.resize(names.size());
+
+    std::unordered_map<std::string, size_t> nodes;
+    for (size_t i = 0; i < names.size(); i++) {
+        m_Duplicates[i] = names[i].empty() ? i : nodes.emplace(names[i], i).first->second;
+    }
+    for (size_t i = 0; i < imports.size() && i < names.size(); i++) {
+        for (auto& name : imports[i]) {
+            auto it = nodes.find(name);
+            if (it == nodes.end()) continue;
+            auto& edges = m_Imports[i];
+            if (std::find(edges.begin(), edges.end(), it->second) != edges.end()) continue;
+            edges.push_back(it->second);
+            m_Importers[it->second].push_back(i);
+        }
+    }
+}
+
+// Tarjan's strongly connected components, with an explicit stack so that a long chain of imports
+// can't overflow the call stack.
+std::vector<std::vector<size_t>> ModuleGraph::BreakCycles() {
+    struct Frame {
+        size_t node;
+        size_t next;                        // Index into m_Imports[node] of the next edge to follow
+    };
+
+    auto count = GetCount();
+    std::vector<size_t> index(count, NONE), low(count, 0), stack;
+    std::vector<bool> isOnStack(count, false);
+    std::vector<Frame> frames;
+    std::vector<std::vector<size_t>> components;
+    size_t counter = 0;
+
+    for (size_t root = 0; root < count; root++) {
+        if (index[root] != NONE) continue;
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        isOnStack[root] = true;
+        frames.push_back({ root, 0 });
+
+        while (!frames.empty()) {
+            auto node = frames.back().node;
+            if (frames.back().next < m_Imports[node].size()) {
+                auto other = m_Imports[node][frames.back().next++];
+                if (index[other] == NONE) {
+                    index[other] = low[other] = counter++;
+                    stack.push_back(other);
+                    isOnStack[other] = true;
+                    frames.push_back({ other, 0 });
+                }
+                else if (isOnStack[other]) low[node] = std::min(low[node], index[other]);
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) low[frames.back().node] = std::min(low[frames.back().node], low[node]);
+            if (low[node] != index[node]) continue;
+
+            std::vector<size_t> component;
+            size_t member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                isOnStack[member] = false;
+                component.push_back(member);
+            } while (member != node);
+            bool isSelfImport = std::find(m_Imports[node].begin(), m_Imports[node].end(), node) != m_Imports[node].end();
+            if (component.size() > 1 || isSelfImport) components.push_back(std::move(component));
+        }
+    }
+
+    // A shortest way round each component, from its first node back to itself, read off a breadth
+    // first search before the edges go.
+    std::vector<std::vector<size_t>> cycles;
+    std::vector<size_t> parent(count, NONE);
+    std::vector<bool> isMember(count, false);
+    for (auto& component : components) {
+        std::sort(component.begin(), component.end());
+        for (auto member : component) isMember[member] = true;
+
+        auto start = component.front();
+        std::vector<size_t> queue { start };
+        size_t last = NONE;
+        for (size_t head = 0; head < queue.size() && last == NONE; head++) {
+            for (auto other : m_Imports[queue[head]]) {
+                if (!isMember[other]) continue;
+                if (other == start) {
+                    last = queue[head];
+                    break;
+                }
+                if (parent[other] != NONE) continue;
+                parent[other] = queue[head];
+                queue.push_back(other);
+            }
+        }
+        std::vector<size_t> cycle;
+        for (auto node = last; node != start; node = parent[node]) cycle.push_back(node);
+        cycle.push_back(start);
+        std::reverse(cycle.begin(), cycle.end());
+        cycles.push_back(std::move(cycle));
+
+        for (auto member : component) {
+            auto imports = m_Imports[member];
+            for (auto other : imports) if (isMember[other]) removeEdge(member, other);
+        }
+        for (auto node : queue) parent[node] = NONE;
+        for (auto member : component) isMember[member] = false;
+    }
+    std::sort(cycles.begin(), cycles.end());
+    return cycles;
+}
+
+void ModuleGraph::removeEdge(size_t from, size_t to) {
+    auto& imports = m_Imports[from];
+    imports.erase(std::find(imports.begin(), imports.end(), to));
+    auto& importers = m_Importers[to];
+    importers.erase(std::find(importers.begin(), importers.end(), from));
+}
+
+std::vector<size_t> ModuleGraph::GetImportOrder() const {
+    std::vector<size_t> waits(GetCount()), order;
+    for (size_t node = 0; node < GetCount(); node++) {
+        waits[node] = m_Imports[node].size();
+        if (waits[node] == 0) order.push_back(node);
+    }
+    for (size_t head = 0; head < order.size(); head++) {
+        for (auto importer : m_Importers[order[head]]) {
+            if (--waits[importer] == 0) order.push_back(importer);
+        }
+    }
+    return order;
+}
+
+double ModuleGraph::GetCriticalPath(const std::vector<double>& weights, std::vector<size_t>& path) const {
+    std::vector<double> finish(GetCount(), 0.0);
+    std::vector<size_t> before(GetCount(), NONE);
+    size_t last = NONE;
+    for (auto node : GetImportOrder()) {
+        for (auto import : m_Imports[node]) {
+            if (before[node] == NONE || finish[import] > finish[before[node]]) before[node] = import;
+        }
+        double start = before[node] != NONE ? finish[before[node]] : 0.0;
+        finish[node] = start + (node < weights.size() ? weights[node] : 0.0);
+        if (last == NONE || finish[node] > finish[last]) last = node;
+    }
+
+    path.clear();
+    for (auto node = last; node != NONE; node = before[node]) path.push_back(node);
+    std::reverse(path.begin(), path.end());
+    return last != NONE ? finish[last] : 0.0;
+}
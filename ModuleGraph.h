@@ -0,0 +1,41 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#pragma once
+
+// The import dependencies between the modules of one build, node i is the i'th unit of the build.
+// Imports of modules that are not in the build are left out, they are taken as already compiled.
+// Modules are matched by name, the package in front of a path import is not looked at.
+class ModuleGraph
+{
+    public:
+        // names[i] is the name of the module in unit i, empty if it is not known, and imports[i] the
+        // modules it imports. A name used by two units belongs to the first one, see GetDuplicate.
+        ModuleGraph(const std::vector<std::string>& names, const std::vector<std::vector<std::string>>& imports);
+
+        size_t GetCount() const { return m_Imports.size(); }
+        // The nodes node imports, and the nodes that import node, both without repeats.
+        const std::vector<size_t>& GetImports(size_t node) const { return m_Imports[node]; }
+        const std::vector<size_t>& GetImporters(size_t node) const { return m_Importers[node]; }
+        // The earlier node with the same name as node, or node itself.
+        size_t GetDuplicate(size_t node) const { return m_Duplicates[node]; }
+
+        // Removes the imports inside every strongly connected component so that the graph is acyclic,
+        // and gives back one cycle through each such component, as the nodes along it. A module that
+        // imports itself is a cycle of one.
+        std::vector<std::vector<size_t>> BreakCycles();
+
+        // The longest path through the graph where every node costs weights[node], in import order.
+        // Nothing is started before its imports are done, so no schedule is shorter than that.
+        double GetCriticalPath(const std::vector<double>& weights, std::vector<size_t>& path) const;
+        // The nodes ordered so that every node comes after its imports. Only complete after BreakCycles.
+        std::vector<size_t> GetImportOrder() const;
+
+    private:
+        void removeEdge(size_t from, size_t to);
+
+        std::vector<std::vector<size_t>> m_Imports;
+        std::vector<std::vector<size_t>> m_Importers;
+        std::vector<size_t> m_Duplicates;
+};
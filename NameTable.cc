@@ -0,0 +1,81 @@
+#include "NameTable.h"
+
+#include <cstring>
+
+static const size_t NAME_BLOCK_SIZE = 64 * 1024;
+static const size_t INITIAL_SLOTS = 1024;
+
+NameTable::NameTable() {
+    m_Entries.push_back({ "", 0, 0 });
+    m_Slots.assign(INITIAL_SLOTS, NO_ATOM);
+    m_BlockCur = nullptr;
+    m_BlockLeft = 0;
+}
+
+// FNV-1a, identifiers are short so anything heavier does not pay off.
+unsigned int NameTable::hashName(const char* text, size_t length) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(text[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+Atom NameTable::Find(const char* text, size_t length) const {
+    auto hash = hashName(text, length);
+    size_t mask = m_Slots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        auto atom = m_Slots[i];
+        if (atom == NO_ATOM) return NO_ATOM;
+        auto& entry = m_Entries[atom];
+        if (entry.hash == hash && entry.length == length && std::memcmp(entry.text, text, length) == 0) return atom;
+    }
+}
+
+Atom NameTable::Intern(const char* text, size_t length) {
+    auto hash = hashName(text, length);
+    size_t mask = m_Slots.size() - 1;
+    size_t i = hash & mask;
+    for ( ; ; i = (i + 1) & mask) {
+        auto atom = m_Slots[i];
+        if (atom == NO_ATOM) break;
+        auto& entry = m_Entries[atom];
+        if (entry.hash == hash && entry.length == length && std::memcmp(entry.text, text, length) == 0) return atom;
+    }
+
+    Atom atom = static_cast<Atom>(m_Entries.size());
+    m_Entries.push_back({ storeText(text, length), static_cast<unsigned int>(length), hash });
+    m_Slots[i] = atom;
+    if (m_Entries.size() * 2 > m_Slots.size()) growSlots();    // Keep load factor below one half
+    return atom;
+}
+
+std::string_view NameTable::GetName(Atom atom) const {
+    auto& entry = m_Entries[atom];
+    return std::string_view(entry.text, entry.length);
+}
+
+const char* NameTable::storeText(const char* text, size_t length) {
+    if (length > m_BlockLeft) {
+        size_t size = length > NAME_BLOCK_SIZE ? length : NAME_BLOCK_SIZE;
+        m_Blocks.emplace_back(new char[size]);
+        m_BlockCur = m_Blocks.back().get();
+        m_BlockLeft = size;
+    }
+    char* stored = m_BlockCur;
+    std::memcpy(stored, text, length);
+    m_BlockCur += length;
+    m_BlockLeft -= length;
+    return stored;
+}
+
+void NameTable::growSlots() {
+    m_Slots.assign(m_Slots.size() * 2, NO_ATOM);
+    size_t mask = m_Slots.size() - 1;
+    for (Atom atom = 1; atom < m_Entries.size(); atom++) {
+        size_t i = m_Entries[atom].hash & mask;
+        while (m_Slots[i] != NO_ATOM) i = (i + 1) & mask;
+        m_Slots[i] = atom;
+    }
+}
@@ -0,0 +1,45 @@
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#pragma once
+
+// Interned identifier. Equal names get equal atoms within one NameTable, 0 is never a valid name.
+typedef unsigned int Atom;
+
+const Atom NO_ATOM = 0;
+
+// String interner for identifiers. Text is copied once into stable blocks, so the views returned
+// by GetName stay valid for the lifetime of the table. Not thread safe, use one table per thread
+// or guard it externally.
+class NameTable
+{
+    public:
+        NameTable();
+
+        Atom Intern(const char* text, size_t length);
+        Atom Intern(std::string_view text) { return Intern(text.data(), text.size()); }
+        // Returns NO_ATOM if the name has never been interned.
+        Atom Find(const char* text, size_t length) const;
+        std::string_view GetName(Atom atom) const;
+        size_t GetCount() const { return m_Entries.size() - 1; }
+
+    private:
+        struct Entry {
+            const char* text;
+            unsigned int length;
+            unsigned int hash;
+        };
+
+        static unsigned int hashName(const char* text, size_t length);
+        const char* storeText(const char* text, size_t length);
+        void growSlots();
+
+        std::vector<Entry> m_Entries;           // Indexed by atom, entry 0 is unused
+        std::vector<Atom> m_Slots;              // Open addressing, power of two size, NO_ATOM is free
+        std::vector<std::unique_ptr<char[]>> m_Blocks;
+        char* m_BlockCur;
+        size_t m_BlockLeft;
+};
@@ -1,6 +1,9 @@
 #include "Parser.h"
 #include "ASTNode.h"
 
+#include <algorithm>
+#include <array>
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Exception:  SyntaxError ////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -9,19 +12,86 @@ SyntaxError::SyntaxError(unsigned int line, unsigned int col, std::string text)
     m_Line = line; m_Col = col; m_Text = text;
 }
 
-std::string SyntaxError::GetExceptionDetails() {
+std::string SyntaxError::GetExceptionDetails() const {
     std::ostringstream ss;
     ss << "( " << m_Line << " : " << m_Col << " ) - " << m_Text << "\r\n";
     return ss.str();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Expression operators ///////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Binding levels of the expression rules, an operand at a level takes the operators of that level and up.
+typedef enum { LEVEL_NONE, LEVEL_RELATION, LEVEL_SIMPLE, LEVEL_TERM, LEVEL_FACTOR } OperatorLevel;
+
+// What a token does in an expression, looked up once per token instead of testing it rule by rule.
+struct ExpressionOperator {
+    unsigned char level;            // Of the binary operator, LEVEL_NONE if the token ends the operand
+    unsigned char infix;            // NodeKind of the binary operator
+    unsigned char prefixLevel;      // Highest level the token starts an operand at as unary operator, or LEVEL_NONE
+    unsigned char operandLevel;     // Of the operand of the unary operator
+    unsigned char prefix;           // NodeKind of the unary operator
+};
+
+static constexpr std::array<ExpressionOperator, T_EOF + 1> makeExpressionOperators() {
+    std::array<ExpressionOperator, T_EOF + 1> table {};
+    auto infix = [&table](TokenCode symbol, OperatorLevel level, NodeKind kind) {
+        table[symbol].level = level;
+        table[symbol].infix = kind;
+    };
+    auto prefix = [&table](TokenCode symbol, OperatorLevel level, OperatorLevel operand, NodeKind kind) {
+        table[symbol].prefixLevel = level;
+        table[symbol].operandLevel = operand;
+        table[symbol].prefix = kind;
+    };
+    infix(T_LESS, LEVEL_RELATION, N_LESS);
+    infix(T_LESSEQUAL, LEVEL_RELATION, N_LESS_EQUAL);
+    infix(T_EQUAL, LEVEL_RELATION, N_EQUAL);
+    infix(T_GREATER, LEVEL_RELATION, N_GREATER);
+    infix(T_GREATEREQUAL, LEVEL_RELATION, N_GREATER_EQUAL);
+    infix(T_HASH, LEVEL_RELATION, N_NOT_EQUAL);
+    infix(T_IN, LEVEL_RELATION, N_IN);
+    infix(T_IS, LEVEL_RELATION, N_IS);
+    infix(T_PLUS, LEVEL_SIMPLE, N_PLUS);
+    infix(T_MINUS, LEVEL_SIMPLE, N_MINUS);
+    infix(T_OR, LEVEL_SIMPLE, N_OR);
+    infix(T_MUL, LEVEL_TERM, N_MUL);
+    infix(T_SLASH, LEVEL_TERM, N_SLASH);
+    infix(T_DIV, LEVEL_TERM, N_DIV);
+    infix(T_MOD, LEVEL_TERM, N_MOD);
+    infix(T_AND, LEVEL_TERM, N_AND);
+    prefix(T_PLUS, LEVEL_SIMPLE, LEVEL_TERM, N_UNARY_PLUS);     // Only in front of the first Term
+    prefix(T_MINUS, LEVEL_SIMPLE, LEVEL_TERM, N_UNARY_MINUS);
+    prefix(T_TILDE, LEVEL_FACTOR, LEVEL_FACTOR, N_BIT_INVERT);
+    return table;
+}
+
+static constexpr auto EXPRESSION_OPERATORS = makeExpressionOperators();
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Exception:  Parser  ////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-Parser::Parser(std::shared_ptr<Tokenizer> lexer)
+// Interleaved lexing and parsing, tokens are pulled from the Tokenizer as the parser needs them.
+Parser::Parser(std::shared_ptr<Tokenizer> lexer, std::shared_ptr<ASTArena> arena)
 {
-    m_Lexer = lexer;
+    m_Lexer = std::make_shared<TokenStream>(lexer);
+    m_Arena = arena != nullptr ? arena : std::make_shared<ASTArena>();
+    if (!m_Lexer->IsInterning()) m_Arena->KeepAlive(m_Lexer->GetSource());
+    m_Arena->KeepAlive(m_Lexer->GetNames());
+    m_IsRecovering = false;
+    m_IsPanicking = false;
+}
+
+Parser::Parser(std::shared_ptr<TokenStream> tokens, std::shared_ptr<ASTArena> arena)
+{
+    m_Lexer = tokens;
+    m_Arena = arena != nullptr ? arena : std::make_shared<ASTArena>();
+    if (!m_Lexer->IsInterning()) m_Arena->KeepAlive(m_Lexer->GetSource());
+    m_Arena->KeepAlive(m_Lexer->GetNames());
+    m_IsRecovering = false;
+    m_IsPanicking = false;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -29,39 +99,103 @@ Parser::Parser(std::shared_ptr<Tokenizer> lexer)
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Rule: module | definition
-std::shared_ptr<ASTNode> Parser::ParseOberon() {
+// A source cut off at SourceBuffer::MAX_LENGTH ends in the middle of something, whatever error the
+// parse runs into there, the error is that it was cut off.
+ASTNode* Parser::ParseOberon() {
     if (m_Lexer == nullptr) throw ;
+    ASTNode* node = nullptr;
+    try {
+        m_Lexer->Advance();
+        switch (m_Lexer->GetSymbol()) {
+            case T_MODULE:      node = ParseModule(); break;
+            case T_DEFINITION:  node = ParseDefinition(); break;
+            case T_EOF:         break;
+            default:
+                ReportError("Expecting 'MODULE' or 'DEFINITION' as start of file!");
+                break;
+        }
+    }
+    catch (const SyntaxError&) {
+        if (!m_Lexer->GetSource()->IsCutOff()) throw;
+    }
+    if (m_Lexer->GetSource()->IsCutOff()) {
+        SyntaxError error(m_Lexer->GetLine(), m_Lexer->GetColumn(), "Source is longer than 4 GiB, the rest is not read!");
+        if (!m_IsRecovering) throw error;
+        while (!m_Diagnostics.empty() && m_Diagnostics.back().GetLine() == error.GetLine()
+               && m_Diagnostics.back().GetColumn() == error.GetColumn()) m_Diagnostics.pop_back();
+        m_Diagnostics.push_back(error);
+    }
+    return node;
+}
+
+// Rule: ( 'MODULE' Ident [ TypeParams ] [ ';' ] { ImportList } | 'DEFINITION' Ident [ ImportList ] ) ...
+ASTNode* Parser::ParseHeader() {
     m_Lexer->Advance();
+    auto pos = m_Lexer->GetOffset();
     switch (m_Lexer->GetSymbol()) {
-        case T_MODULE:      return ParseModule();
-        case T_DEFINITION:  return ParseDefinition();
+        case T_MODULE:
+            {
+                m_Lexer->Advance();
+                auto moduleName = CheckName("Name of module is missing!");
+                m_Lexer->Advance();
+                auto typeParams = m_Lexer->GetSymbol() == T_LEFTPAREN ? ParseTypeParams() : nullptr;
+                if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
+                auto mark = m_NodeStack.size();
+                while (m_Lexer->GetSymbol() == T_IMPORT && !m_IsPanicking) m_NodeStack.push_back(ParseImportList());
+                return ASTNode::MakeModuleNode(*m_Arena, pos, moduleName, typeParams, TakeNodes(mark), nullptr);
+            }
+        case T_DEFINITION:
+            {
+                m_Lexer->Advance();
+                auto defName = CheckName("Missing definition name!");
+                m_Lexer->Advance();
+                auto left = m_Lexer->GetSymbol() == T_IMPORT ? ParseImportList() : nullptr;
+                return ASTNode::MakeDeclarationNode(*m_Arena, pos, defName, left, nullptr);
+            }
         case T_EOF:         return nullptr;
-        default:            throw std::make_shared<SyntaxError>(m_Lexer->GetLine(), m_Lexer->GetColumn(), "Expecting 'MODULE' or 'DEFINITION' as start of file!");
+        default:
+            ReportError("Expecting 'MODULE' or 'DEFINITION' as start of file!");
+            return nullptr;
+    }
+}
+
+// Rule: Statement | ImportList | DeclarationSequence | ConstDeclaration | TypeDeclaration | VariableDeclaration | ProcedureDeclaration | ProcedureHeading
+ASTNode* Parser::ParseListItem(NodeKind owner, NodeKind item) {
+    m_Lexer->Advance();
+    if (owner == N_STATEMENT_SEQUENCE) return ParseStatement();
+    switch (item) {
+        case N_IMPORT_LIST:             return ParseImportList();
+        case N_DECLARATION_SEQUENCE:    return ParseDeclarationSequence(false);
+        case N_CONST_DECLARATION:       return ParseConstDeclaration();
+        case N_TYPE_DECLARATION:        return ParseTypeDeclaration();
+        case N_VARIABLE_DECLARATION:    return ParseVariableDeclararation();
+        case N_PROCEDURE_DECLARATION:   return ParseProcedureDeclaration();
+        case N_PROCEDURE_HEADING:       return ParseProcedureHeading();
+        default:
+            ReportError("Expecting start of a list item!");
+            return nullptr;
     }
 }
 
 // Rule: [ ident '.' ] ident
-std::shared_ptr<ASTNode> Parser::ParseQualident() {
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    CheckSymbol(TokenCode::T_IDENT, "Expecting name literal!");
-    auto literalText = m_Lexer->GetText();
+ASTNode* Parser::ParseQualident() {
+    auto pos = m_Lexer->GetOffset();
+    auto name = CheckName("Expecting name literal!");
     m_Lexer->Advance();
     if (m_Lexer->GetSymbol() == TokenCode::T_DOT) {
         m_Lexer->Advance();
-        CheckSymbol(TokenCode::T_IDENT, "Expecting name literal after '.' in qualident!");
-        auto literalText2 = m_Lexer->GetText();
+        auto name2 = CheckName("Expecting name literal after '.' in qualident!");
         m_Lexer->Advance();
-        return ASTNode::MakeQualidentNode(line, col, literalText, literalText2);
+        return ASTNode::MakeQualidentNode(*m_Arena, pos, name, name2);
     }
-    return ASTNode::MakeIdentNode(line, col, literalText);
+    return ASTNode::MakeIdentNode(*m_Arena, pos, name);
 }
 
 // Rule: ident [ '*' | '-' ]
-std::shared_ptr<ASTNode> Parser::ParseIdentDef() 
+ASTNode* Parser::ParseIdentDef() 
 {
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    CheckSymbol(TokenCode::T_IDENT, "Expecting name literal!");
-    auto literalText = m_Lexer->GetText();
+    auto pos = m_Lexer->GetOffset();
+    auto name = CheckName("Expecting name literal!");
     m_Lexer->Advance();
     bool isReadOnlyExport = false, isExport = false;
     switch (m_Lexer->GetSymbol()) {
@@ -76,35 +210,34 @@ std::shared_ptr<ASTNode> Parser::ParseIdentDef()
         default:    break;
     }
 
-    return ASTNode::MakeIdentDefNode(line, col, literalText, isReadOnlyExport, isExport); 
+    return ASTNode::MakeIdentDefNode(*m_Arena, pos, name, isReadOnlyExport, isExport); 
 }
 
 // Rule: IdentDef '=' ConstExpression
-std::shared_ptr<ASTNode> Parser::ParseConstDeclaration() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseConstDeclaration() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseIdentDef();
     CheckSymbolAndAdvance(T_EQUAL, "Expecting '=' in Const declaration!");
     auto right = ParseConstExpression();
-    return ASTNode::MakeConstDeclarationNode(line, col, left, right); 
+    return ASTNode::MakeConstDeclarationNode(*m_Arena, pos, left, right); 
 }
 
 // Rule: Expression
-std::shared_ptr<ASTNode> Parser::ParseConstExpression() { 
+ASTNode* Parser::ParseConstExpression() { 
     return ParseExpression(); 
 }
 
 // Rule: IdentDef '=' Type
-std::shared_ptr<ASTNode> Parser::ParseTypeDeclaration() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseTypeDeclaration() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseIdentDef();
     CheckSymbolAndAdvance(T_EQUAL, "Expecting '=' ion Type declaration!");
     auto right = ParseType();
-    return ASTNode::MakeTypeDeclarationNode(line, col, left, right); 
+    return ASTNode::MakeTypeDeclarationNode(*m_Arena, pos, left, right); 
 }
 
 // Rule: NamedType | EnumerationType | ArrayType | RecordType | PointerType | ProcedureType
-std::shared_ptr<ASTNode> Parser::ParseType() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseType() { 
     switch (m_Lexer->GetSymbol()) {
         case T_IDENT:       return ParseNamedType();
         case T_LEFTPAREN:   return ParseEnumeration();
@@ -115,54 +248,52 @@ std::shared_ptr<ASTNode> Parser::ParseType() {
         case T_POINTER:     return ParsePointerType();
         case T_PROCEDURE:
         case T_PROC:        return ParseProcedureType();
-        default:            throw SyntaxError(m_Lexer->GetLine(), m_Lexer->GetColumn(), "Illegal Type!");;
+        default:
+            ReportError("Illegal Type!");
+            return nullptr;
     }
 }
 
 // Rule: Qualident
-std::shared_ptr<ASTNode> Parser::ParseNamedType() { 
+ASTNode* Parser::ParseNamedType() { 
     return ParseQualident(); 
 }
 
 // Rule: '(' ident { [ ','  ident ] } ')'
-std::shared_ptr<ASTNode> Parser::ParseTypeParams() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto nodes = std::make_shared<std::vector<std::string>>();
+ASTNode* Parser::ParseTypeParams() { 
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NameStack.size();
     CheckSymbolAndAdvance(T_LEFTPAREN, "Expecting '(' in Type Params!");
-    CheckSymbol(T_IDENT, "Expecting name literal in Type Params!");
-    nodes->push_back(m_Lexer->GetText());
+    m_NameStack.push_back(CheckName("Expecting name literal in Type Params!"));
     m_Lexer->Advance();
-    while (m_Lexer->GetSymbol() != T_RIGHTPAREN) {
+    while (m_Lexer->GetSymbol() != T_RIGHTPAREN && !m_IsPanicking) {
         if (m_Lexer->GetSymbol() == T_COMMA) m_Lexer->Advance();
-        CheckSymbol(T_IDENT, "Expecting name literal in Type Params!");
-        nodes->push_back(m_Lexer->GetText());
+        m_NameStack.push_back(CheckName("Expecting name literal in Type Params!"));
         m_Lexer->Advance();
     }
-    m_Lexer->Advance();
-    return ASTNode::MakeTypeParamsNode(line, col, nodes); 
+    CheckSymbolAndAdvance(T_RIGHTPAREN, "Expecting ')' in Type Params!");
+    return ASTNode::MakeTypeParamsNode(*m_Arena, pos, TakeNames(mark)); 
 }
 
 // Rule: '(' ident { [ ',' ] ident } ')'
-std::shared_ptr<ASTNode> Parser::ParseEnumeration() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseEnumeration() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
-    auto nodes = std::make_shared<std::vector<std::string>>();
-    CheckSymbol(T_IDENT, "Expecting name of enumeration element!");
-    nodes->push_back(m_Lexer->GetText());
+    auto mark = m_NameStack.size();
+    m_NameStack.push_back(CheckName("Expecting name of enumeration element!"));
     m_Lexer->Advance();
-    while (m_Lexer->GetSymbol() != T_RIGHTPAREN) {
+    while (m_Lexer->GetSymbol() != T_RIGHTPAREN && !m_IsPanicking) {
         if (m_Lexer->GetSymbol() == T_COMMA) m_Lexer->Advance();
-        CheckSymbol(T_IDENT, "Expecting name of enumeration element!");
-        nodes->push_back(m_Lexer->GetText());
+        m_NameStack.push_back(CheckName("Expecting name of enumeration element!"));
         m_Lexer->Advance();
     }
-    m_Lexer->Advance(); // ')'
-    return ASTNode::MakeEnumerationNode(line, col, nodes);
+    CheckSymbolAndAdvance(T_RIGHTPAREN, "Expecting ')' at end of enumeration!");
+    return ASTNode::MakeEnumerationNode(*m_Arena, pos, TakeNames(mark));
 }
 
 // Rule: 'ARRAY' '[' LengthList ']' 'OF' Type | '[' [ LengthList ] ']' Type
-std::shared_ptr<ASTNode> Parser::ParseArrayType() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseArrayType() { 
+    auto pos = m_Lexer->GetOffset();
     if (m_Lexer->GetSymbol() == T_ARRAY) {
         m_Lexer->Advance();
         CheckSymbolAndAdvance(T_LEFTBRACKET, "Expecting '[' in 'ARRAY' type!");
@@ -170,69 +301,69 @@ std::shared_ptr<ASTNode> Parser::ParseArrayType() {
         CheckSymbolAndAdvance(T_RIGHTBRACKET, "Expecting ']' in 'ARRAY' type!");
         CheckSymbolAndAdvance(T_OF, "Expecting 'OF' in 'ARRAY' type!");
         auto right = ParseType();
-        return ASTNode::MakeArrayOfNode(line, col, left, right);
+        return ASTNode::MakeArrayOfNode(*m_Arena, pos, left, right);
     }
     else {
         CheckSymbolAndAdvance(T_LEFTBRACKET, "Expecting '[' in 'ARRAY' type!");
         auto left = m_Lexer->GetSymbol() != T_RIGHTBRACKET ? ParseLengthList() : nullptr;
         CheckSymbolAndAdvance(T_RIGHTBRACKET, "Expecting ']' in 'ARRAY' type!");
         auto right = ParseType();
-        return ASTNode::MakeArrayNode(line, col, left, right);
+        return ASTNode::MakeArrayNode(*m_Arena, pos, left, right);
     }
 }
 
 // Rule: Length { ',' Length } | 'VAR' varlength { ',' varlength }
-std::shared_ptr<ASTNode> Parser::ParseLengthList() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
+ASTNode* Parser::ParseLengthList() { 
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NodeStack.size();
     if (m_Lexer->GetSymbol() == T_VAR) {
         m_Lexer->Advance();
-        nodes->push_back(ParseVarLength());
+        m_NodeStack.push_back(ParseVarLength());
         while (m_Lexer->GetSymbol() == T_COMMA) {
             m_Lexer->Advance();
-            nodes->push_back(ParseVarLength());
+            m_NodeStack.push_back(ParseVarLength());
         }
-        return ASTNode::MakeLengthList(line, col, true, nodes);
+        return ASTNode::MakeLengthList(*m_Arena, pos, true, TakeNodes(mark));
     }
-    nodes->push_back(ParseLength());
+    m_NodeStack.push_back(ParseLength());
     while (m_Lexer->GetSymbol() == T_COMMA) {
         m_Lexer->Advance();
-        nodes->push_back(ParseLength());
+        m_NodeStack.push_back(ParseLength());
     }
-    return ASTNode::MakeLengthList(line, col, false, nodes);
+    return ASTNode::MakeLengthList(*m_Arena, pos, false, TakeNodes(mark));
 }
 
 // Rule: ConstExpression
-std::shared_ptr<ASTNode> Parser::ParseLength() { 
+ASTNode* Parser::ParseLength() { 
     return ParseExpression(); 
 }
 
 // Rule: Expression
-std::shared_ptr<ASTNode> Parser::ParseVarLength() { 
+ASTNode* Parser::ParseVarLength() { 
     return ParseExpression(); 
 }
 
 // Rule: '(' NamedType { [ ',' ] NamedType } ')'
-std::shared_ptr<ASTNode> Parser::ParseTypeActuals() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseTypeActuals() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
+    auto mark = m_NodeStack.size();
     CheckSymbol(T_IDENT, "Expecting name of enumeration element!");
-    nodes->push_back(ParseNamedType());
-    while (m_Lexer->GetSymbol() != T_RIGHTPAREN) {
+    m_NodeStack.push_back(ParseNamedType());
+    while (m_Lexer->GetSymbol() != T_RIGHTPAREN && !m_IsPanicking) {
         if (m_Lexer->GetSymbol() == T_COMMA) m_Lexer->Advance();
         CheckSymbol(T_IDENT, "Expecting name of enumeration element!");
-        nodes->push_back(ParseNamedType());
+        m_NodeStack.push_back(ParseNamedType());
     }
-    m_Lexer->Advance(); // ')'
-    return ASTNode::MakeTypeActualsNode(line, col, nodes); 
+    CheckSymbolAndAdvance(T_RIGHTPAREN, "Expecting ')' in Type Actuals!");
+    return ASTNode::MakeTypeActualsNode(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 // Rule: 'RECORD' [ '(' BaseType ')' ] [ FieldSequence ] 'END'
-std::shared_ptr<ASTNode> Parser::ParseRecordType() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseRecordType() { 
+    auto pos = m_Lexer->GetOffset();
     CheckSymbolAndAdvance(T_RECORD, "Expecting 'RECORD'!");
-    std::shared_ptr<ASTNode> left = nullptr; // BaseType
+    ASTNode* left = nullptr; // BaseType
     if (m_Lexer->GetSymbol() == T_LEFTPAREN) {
         m_Lexer->Advance();
         left = ParseBaseType();
@@ -240,66 +371,66 @@ std::shared_ptr<ASTNode> Parser::ParseRecordType() {
     }
     auto right = m_Lexer->GetSymbol() != T_END ? ParseFieldListSequence() : nullptr;
     CheckSymbolAndAdvance(T_END, "Expecting 'END' at end of 'RECORD' type!");
-    return ASTNode::MakeRecordTypeNode(line, col, left, right); 
+    return ASTNode::MakeRecordTypeNode(*m_Arena, pos, left, right); 
 }
 
 // Rule: NamedType
-std::shared_ptr<ASTNode> Parser::ParseBaseType() { 
+ASTNode* Parser::ParseBaseType() { 
     return ParseNamedType(); 
 }
 
 // Rule: FieldList [ ';' ] { FieldList [ ';' ] }
-std::shared_ptr<ASTNode> Parser::ParseFieldListSequence() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    nodes->push_back(ParseFieldList());
-    while (m_Lexer->GetSymbol() != T_END) {
+ASTNode* Parser::ParseFieldListSequence() { 
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NodeStack.size();
+    m_NodeStack.push_back(ParseFieldList());
+    while (m_Lexer->GetSymbol() != T_END && !m_IsPanicking) {
         if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
-        if (m_Lexer->GetSymbol() != T_END) nodes->push_back(ParseFieldList());
+        if (m_Lexer->GetSymbol() != T_END) m_NodeStack.push_back(ParseFieldList());
     }
-    return ASTNode::MakeFieldListSequenceNode(line, col, nodes); 
+    return ASTNode::MakeFieldListSequenceNode(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 // Rule: IdentList ':' Type
-std::shared_ptr<ASTNode> Parser::ParseFieldList() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseFieldList() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseIdentList();
     CheckSymbolAndAdvance(T_COLON, "Expecting ':' in Field declaration of 'RECORD'!");
     auto right = ParseType();
-    return ASTNode::MakeFieldListNode(line, col, left, right); 
+    return ASTNode::MakeFieldListNode(*m_Arena, pos, left, right); 
 }
 
 // Rule: Identdef { [','] Identdef }
-std::shared_ptr<ASTNode> Parser::ParseIdentList() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    nodes->push_back(ParseIdentDef());
-    while (m_Lexer->GetSymbol() != T_COLON) {
+ASTNode* Parser::ParseIdentList() { 
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NodeStack.size();
+    m_NodeStack.push_back(ParseIdentDef());
+    while (m_Lexer->GetSymbol() != T_COLON && !m_IsPanicking) {
         if (m_Lexer->GetSymbol() == T_COMMA) m_Lexer->Advance();
-        nodes->push_back(ParseIdentDef());
+        m_NodeStack.push_back(ParseIdentDef());
     }
-    return ASTNode::MakeIdentListNode(line, col, nodes); 
+    return ASTNode::MakeIdentListNode(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 // Rule: ( 'POINTER' 'TO' | '^' ) Type
-std::shared_ptr<ASTNode> Parser::ParsePointerType() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParsePointerType() { 
+    auto pos = m_Lexer->GetOffset();
     if (m_Lexer->GetSymbol() == T_POINTER) {
         m_Lexer->Advance();
         CheckSymbolAndAdvance(T_TO, "Expecting 'TO' in pointer declaration!");
         auto right = ParseType();
-        return ASTNode::MakePointerNode(line, col, false, right);
+        return ASTNode::MakePointerNode(*m_Arena, pos, false, right);
     }
     else {
         CheckSymbolAndAdvance(T_ARROW, "Expecting '^' in pointer declaration!");
         auto right = ParseType();
-        return ASTNode::MakePointerNode(line, col, true, right);
+        return ASTNode::MakePointerNode(*m_Arena, pos, true, right);
     }
 }
 
 // Rule: ( 'PROCEDURE' | 'PROC' ) [ '(' ( 'POINTER' | '^' ) ')' ] [ FormapParameters ]
-std::shared_ptr<ASTNode> Parser::ParseProcedureType() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseProcedureType() { 
+    auto pos = m_Lexer->GetOffset();
     bool isProc = false;
     if (m_Lexer->GetSymbol() == T_PROCEDURE) m_Lexer->Advance();
     else {
@@ -308,7 +439,7 @@ std::shared_ptr<ASTNode> Parser::ParseProcedureType() {
     }
     bool isArrow = false;
     bool isPointer = false;
-    std::shared_ptr<ASTNode> right = nullptr; 
+    ASTNode* right = nullptr; 
     if (m_Lexer->GetSymbol() == T_LEFTPAREN) {
         m_Lexer->Advance();
         if (m_Lexer->GetSymbol() == T_POINTER) {
@@ -331,288 +462,169 @@ std::shared_ptr<ASTNode> Parser::ParseProcedureType() {
             right = ParseFormalParameters();            
         }
     }
-    return ASTNode::MakeProcedureTypeNode(line, col, isProc, isPointer, isArrow, right); 
+    return ASTNode::MakeProcedureTypeNode(*m_Arena, pos, isProc, isPointer, isArrow, right); 
 }
 
 // Rule: IdentList ':' Type
-std::shared_ptr<ASTNode> Parser::ParseVariableDeclararation() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseVariableDeclararation() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseIdentList();
     CheckSymbolAndAdvance(T_COLON, "Expecting ':' in Variable declaration!");
     auto right = ParseType();
-    return ASTNode::MakeVariableDeclarationNode(line, col, left, right); 
+    return ASTNode::MakeVariableDeclarationNode(*m_Arena, pos, left, right); 
 }
 
 // Rule: Qualident { Selector } 
-std::shared_ptr<ASTNode> Parser::ParseDesignator() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseDesignator() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseQualident();
     if (m_Lexer->GetSymbol() == T_DOT || m_Lexer->GetSymbol() == T_LEFTPAREN || m_Lexer->GetSymbol() == T_LEFTBRACKET || m_Lexer->GetSymbol() == T_ARROW) {
-        auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
+        auto mark = m_NodeStack.size();
         while (m_Lexer->GetSymbol() == T_DOT || m_Lexer->GetSymbol() == T_LEFTPAREN || m_Lexer->GetSymbol() == T_LEFTBRACKET || m_Lexer->GetSymbol() == T_ARROW) 
-            nodes->push_back(ParseSelector());
-        return ASTNode::MakeDesignatorNode(line, col, left, nodes);
+            m_NodeStack.push_back(ParseSelector());
+        return ASTNode::MakeDesignatorNode(*m_Arena, pos, left, TakeNodes(mark));
     }
     return left; 
 }
 
 // Rule: '.' ident | '[' ExpList '] | '^' | '(' Qualident ')
-std::shared_ptr<ASTNode> Parser::ParseSelector() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseSelector() { 
+    auto pos = m_Lexer->GetOffset();
     switch (m_Lexer->GetSymbol()) {
         case T_DOT:
             {
                 m_Lexer->Advance();
-                CheckSymbol(T_IDENT, "Expecting name literal after '.'");
-                auto text = m_Lexer->GetText();
+                auto name = CheckName("Expecting name literal after '.'");
                 m_Lexer->Advance();
-                return ASTNode::MakeDotNameNode(line, col, text);
+                return ASTNode::MakeDotNameNode(*m_Arena, pos, name);
             }
         case T_LEFTPAREN:
             {
                 m_Lexer->Advance();
                 auto right = ParseQualident();
                 CheckSymbolAndAdvance(T_RIGHTPAREN, "Expecting ')' in selector!");
-                return ASTNode::MakeCallQualidentNode(line, col, right);
+                return ASTNode::MakeCallQualidentNode(*m_Arena, pos, right);
             }
         case T_LEFTBRACKET:
             {
                 m_Lexer->Advance();
                 auto right = ParseExpList();
                 CheckSymbolAndAdvance(T_RIGHTBRACKET, "Expected ']' in indexing!");
-                return ASTNode::MakeIndexNode(line, col, right);
+                return ASTNode::MakeIndexNode(*m_Arena, pos, right);
             }
         default:    // T_ARROW:
             m_Lexer->Advance();
-            return ASTNode::MakeArrowNode(line, col);
+            return ASTNode::MakeArrowNode(*m_Arena, pos);
     }
 }
 
 // Rule: Expression { ',' Expression }
-std::shared_ptr<ASTNode> Parser::ParseExpList() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    nodes->push_back(ParseExpression());
+ASTNode* Parser::ParseExpList() { 
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NodeStack.size();
+    m_NodeStack.push_back(ParseExpression());
     while (m_Lexer->GetSymbol() == T_COMMA) {
         m_Lexer->Advance();
-        nodes->push_back(ParseExpression());
+        m_NodeStack.push_back(ParseExpression());
     }
 
-    return ASTNode::MakeExpressionListNode(line, col, nodes); 
+    return ASTNode::MakeExpressionListNode(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 // Rule: SimpleExpression [ ( '<' | '<=' | '=' | '>=' | '>' | '#' | 'IN' | 'IS' ) SimpleExpression ]
-std::shared_ptr<ASTNode> Parser::ParseExpression() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto left = ParseSimpleExpression();
-    switch (m_Lexer->GetSymbol()) {
-        case T_LESS:
-            {
-                m_Lexer->Advance();
-                auto right = ParseSimpleExpression();
-                return ASTNode::MakeLessCompareNode(line, col, left, right);
-            }
-        case T_LESSEQUAL:
-            {
-                m_Lexer->Advance();
-                auto right = ParseSimpleExpression();
-                return ASTNode::MakeLessEqualCompareNode(line, col, left, right);
-            }
-        case T_EQUAL:
-            {
-                m_Lexer->Advance();
-                auto right = ParseSimpleExpression();
-                return ASTNode::MakeEqualCompareNode(line, col, left, right);
-            }
-        case T_GREATER:
-            {
-                m_Lexer->Advance();
-                auto right = ParseSimpleExpression();
-                return ASTNode::MakeGreaterCompareNode(line, col, left, right);
-            }
-        case T_GREATEREQUAL:
-            {
-                m_Lexer->Advance();
-                auto right = ParseSimpleExpression();
-                return ASTNode::MakeGreaterEqualCompareNode(line, col, left, right);
-            }
-        case T_HASH:
-            {
-                m_Lexer->Advance();
-                auto right = ParseSimpleExpression();
-                return ASTNode::MakeNotEqualCompareNode(line, col, left, right);
-            }
-        case T_IN:
-            {
-                m_Lexer->Advance();
-                auto right = ParseSimpleExpression();
-                return ASTNode::MakeInCompareNode(line, col, left, right);
-            }
-        case T_IS:
-            {
-                m_Lexer->Advance();
-                auto right = ParseSimpleExpression();
-                return ASTNode::MakeIsCompareNode(line, col, left, right);
-            }
-        default:    return left;
-    }
-}
-
-// Rule: [ '+' | '-' ] Term { ( '+' | '-' | 'OR' ) Term }
-std::shared_ptr<ASTNode> Parser::ParseSimpleExpression() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    std::shared_ptr<ASTNode> left = nullptr;
-
-    if (m_Lexer->GetSymbol() == T_PLUS || m_Lexer->GetSymbol() == T_MINUS) {
-        if (m_Lexer->GetSymbol() == T_PLUS) {
-            m_Lexer->Advance();
-            auto right = ParseTerm();
-            left = ASTNode::MakeUnaryPlusNode(line, col, right);
-        }
-        else {
-            m_Lexer->Advance();
-            auto right = ParseTerm();
-            left = ASTNode::MakeUnaryMinusNode(line, col, right);
-        }
+ASTNode* Parser::ParseExpression() { 
+    return ParseOperand(LEVEL_RELATION);
+}
+
+// Rule: SimpleExpression = [ '+' | '-' ] Term { ( '+' | '-' | 'OR' ) Term }
+//       Term = Factor { ( '*' | '/' | 'DIV' | 'MOD' | '&' ) Factor }
+//       Factor = '~' Factor | Primary
+// Precedence climbing: an operand at level, with the operators binding at least as tight as level.
+// Binary nodes get the position of the operand they start, as in the rules above.
+ASTNode* Parser::ParseOperand(unsigned int level) { 
+    auto pos = m_Lexer->GetOffset();
+    ASTNode* left = nullptr;
+    auto& prefix = EXPRESSION_OPERATORS[m_Lexer->GetSymbol()];
+    if (level <= prefix.prefixLevel) {
+        m_Lexer->Advance();
+        auto right = ParseOperand(prefix.operandLevel);
+        left = ASTNode::MakeUnaryNode(*m_Arena, static_cast<NodeKind>(prefix.prefix), pos, right);
     }
     else {
-        left = ParseTerm();
-    }
-
-    while (m_Lexer->GetSymbol() == T_PLUS || m_Lexer->GetSymbol() == T_MINUS || m_Lexer->GetSymbol() == T_OR) {
-        switch (m_Lexer->GetSymbol()) {
-            case T_PLUS:
-                {
-                    m_Lexer->Advance();
-                    auto right1 = ParseTerm();
-                    left = ASTNode::MakePlusNode(line, col, left, right1);
-                }
-                break;
-            case T_MINUS:
-                {
-                    m_Lexer->Advance();
-                    auto right2 = ParseTerm();
-                    left = ASTNode::MakeOrNode(line, col, left, right2);
-                }
-                break;
-            default:
-                {
-                    m_Lexer->Advance();
-                    auto right3 = ParseTerm();
-                    left = ASTNode::MakeOrNode(line, col, left, right3);
-                }
-                break;
-        }
+        left = ParseFactor();
     }
 
-    return left;
-}
-
-// Rule: Factor { ( '*' | '/' | 'DIV' | 'MOD' | '&' ) Factor }
-std::shared_ptr<ASTNode> Parser::ParseTerm() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto left = ParseFactor();
-    while (m_Lexer->GetSymbol() == T_MUL || m_Lexer->GetSymbol() == T_SLASH || m_Lexer->GetSymbol() == T_DIV || m_Lexer->GetSymbol() == T_MOD || m_Lexer->GetSymbol() == T_AND) {
-        switch (m_Lexer->GetSymbol()) {
-            case T_MUL:
-                {
-                    m_Lexer->Advance();
-                    auto right = ParseFactor();
-                    left = ASTNode::MakeMulNode(line, col, left, right);
-                }
-                break;
-            case T_SLASH:
-                {
-                    m_Lexer->Advance();
-                    auto right = ParseFactor();
-                    left = ASTNode::MakeSlashNode(line, col, left, right);
-                }
-                break;
-            case T_DIV:
-                {
-                    m_Lexer->Advance();
-                    auto right = ParseFactor();
-                    left = ASTNode::MakeDivNode(line, col, left, right);
-                }
-                break;
-            case T_MOD:
-                {
-                    m_Lexer->Advance();
-                    auto right = ParseFactor();
-                    left = ASTNode::MakeModNode(line, col, left, right);
-                }
-                break;
-            default:
-                {
-                    m_Lexer->Advance();
-                    auto right = ParseFactor();
-                    left = ASTNode::MakeAndNode(line, col, left, right);
-                }
-                break;
-        }
+    while (true) {
+        auto& infix = EXPRESSION_OPERATORS[m_Lexer->GetSymbol()];
+        if (infix.level < level) return left;
+        m_Lexer->Advance();
+        auto right = ParseOperand(infix.level + 1);
+        left = ASTNode::MakeBinaryNode(*m_Arena, static_cast<NodeKind>(infix.infix), pos, left, right);
+        if (infix.level == LEVEL_RELATION) return left; // Relations don't chain
     }
-    return left; 
 }
 
 // Rule: Number | String | HexString | HexChar | 'NIL' | 'TRUE' | 'FALSE' | Set
-std::shared_ptr<ASTNode> Parser::ParseLiteral() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseLiteral() { 
+    auto pos = m_Lexer->GetOffset();
     switch (m_Lexer->GetSymbol()) {
         case T_NUMBER:
             {
-                auto text = m_Lexer->GetText();
+                auto value = m_Lexer->GetNumber();
                 m_Lexer->Advance();
-                return ASTNode::MakeLiteralNumberNode(line, col, text);
+                return ASTNode::MakeLiteralNumberNode(*m_Arena, pos, value);
             }
         case T_STRING:
             {
-                auto text = m_Lexer->GetText();
+                auto text = m_Lexer->GetSpan();
                 m_Lexer->Advance();
-                return ASTNode::MakeLiteralStringNode(line, col, text);
+                return ASTNode::MakeLiteralStringNode(*m_Arena, pos, text);
             }
         case T_HEX_STRING:
             {
-                auto text = m_Lexer->GetText();
+                auto text = m_Lexer->GetSpan();
                 m_Lexer->Advance();
-                return ASTNode::MakeLiteralHexStringNode(line, col, text);
+                return ASTNode::MakeLiteralHexStringNode(*m_Arena, pos, text);
             }
         case T_HEX_CHAR:
-        {
-                auto text = m_Lexer->GetText();
+            {
+                auto value = m_Lexer->GetNumber();
                 m_Lexer->Advance();
-                return ASTNode::MakeLiteralHexCharNode(line, col, text);
+                return ASTNode::MakeLiteralHexCharNode(*m_Arena, pos, value);
             }
         case T_NIL:
             {
                 m_Lexer->Advance();
-                return ASTNode::MakeLiteralNilNode(line, col);
+                return ASTNode::MakeLiteralNilNode(*m_Arena, pos);
             }
         case T_TRUE:
             {
                 m_Lexer->Advance();
-                return ASTNode::MakeLiteralTrueNode(line, col);
+                return ASTNode::MakeLiteralTrueNode(*m_Arena, pos);
             }
         case T_FALSE:
             {
                 m_Lexer->Advance();
-                return ASTNode::MakeLiteralFalseNode(line, col);
+                return ASTNode::MakeLiteralFalseNode(*m_Arena, pos);
             }
         case T_LEFTCURLY:
                 return ParseSet();
-        default:    throw SyntaxError(m_Lexer->GetLine(), m_Lexer->GetColumn(), "Illegal literal!");
+        default:
+            ReportError("Illegal literal!");
+            return nullptr;
     }
 }
 
-// Rule: Literal | Designator [ ActualParameters ] | '(' Expression ')' | '~' Factor
-std::shared_ptr<ASTNode> Parser::ParseFactor() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+// Rule: Literal | Designator [ ActualParameters ] | '(' Expression ')'
+ASTNode* Parser::ParseFactor() { 
+    auto pos = m_Lexer->GetOffset();
     switch (m_Lexer->GetSymbol()) {
         case T_IDENT:
             {
                 auto left = ParseDesignator();
                 if (m_Lexer->GetSymbol() != T_LEFTPAREN) return left;
                 auto right = ParseActualParameters();
-                return ASTNode::MakeCallNode(line, col, left, right);
+                return ASTNode::MakeCallNode(*m_Arena, pos, left, right);
             }
         case T_LEFTPAREN:
             {
@@ -621,56 +633,50 @@ std::shared_ptr<ASTNode> Parser::ParseFactor() {
                 CheckSymbolAndAdvance(T_RIGHTPAREN, "Expecting ')' in expression!");
                 return right;
             }
-        case T_TILDE:
-            {
-                m_Lexer->Advance();
-                auto right = ParseFactor();
-                return ASTNode::MakeBitInvertNode(line, col, right);
-            }
         default:    return ParseLiteral();
     } 
 }
 
 // Rule: '{' [ Element { ',' Element } ] '}'
-std::shared_ptr<ASTNode> Parser::ParseSet() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseSet() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
+    auto mark = m_NodeStack.size();
     if (m_Lexer->GetSymbol() != T_RIGHTCURLY) {
-        nodes->push_back(ParseElement());
+        m_NodeStack.push_back(ParseElement());
         while (m_Lexer->GetSymbol() == T_COMMA) {
             m_Lexer->Advance();
-            nodes->push_back(ParseElement());
+            m_NodeStack.push_back(ParseElement());
         }
     }
     CheckSymbolAndAdvance(T_RIGHTCURLY, "Expecting '}' at end of set!");
-    return ASTNode::MakeSetNode(line, col, nodes); 
+    return ASTNode::MakeSetNode(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 // Rule: Expression [ '..' Expression ]
-std::shared_ptr<ASTNode> Parser::ParseElement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseElement() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseExpression();
     if (m_Lexer->GetSymbol() == T_UPTO) {
         m_Lexer->Advance();
         auto right = ParseExpression();
-        return ASTNode::MakeElementNode(line, col, left, right);
+        return ASTNode::MakeElementNode(*m_Arena, pos, left, right);
     }
     return left; 
 }
 
 // Rule: '(' [ ExpList ] ')'
-std::shared_ptr<ASTNode> Parser::ParseActualParameters() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseActualParameters() { 
+    auto pos = m_Lexer->GetOffset();
     CheckSymbolAndAdvance(T_LEFTPAREN, "Expecting '(' in Parameters!");
     auto right = m_Lexer->GetSymbol() != T_RIGHTPAREN ? ParseExpList() : nullptr;
     CheckSymbolAndAdvance(T_RIGHTPAREN, "Expecting ')' in Parameters!");
-    return ASTNode::MakeActualParametersNode(line, col, right); 
+    return ASTNode::MakeActualParametersNode(*m_Arena, pos, right); 
 }
 
 // Rule: IfStatement | CaseStatement | WithStatement | LoopStatement | ExitStatement | ReturnStatement | WhileStatement | RepeatStatement | ForStatement | Assignment | ProcedureCall
-std::shared_ptr<ASTNode> Parser::ParseStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseStatement() { 
+    auto pos = m_Lexer->GetOffset();
     switch (m_Lexer->GetSymbol()) {
         case T_IF:      return ParseIfStatement();
         case T_CASE:    return ParseCaseStatement();
@@ -685,35 +691,41 @@ std::shared_ptr<ASTNode> Parser::ParseStatement() {
             {
                 auto left = ParseDesignator();
                 switch (m_Lexer->GetSymbol()) {
-                    case T_ASSIGN:      return ParseAssignment(line, col, left);
-                    case T_LEFTPAREN:   return ParseProcedureCall(line, col, left);
+                    case T_ASSIGN:      return ParseAssignment(pos, left);
+                    case T_LEFTPAREN:   return ParseProcedureCall(pos, left);
                     default:    return left;
                 }
             }
-        default:    throw SyntaxError(line, col, "Expecting statement!");
+        default:
+            ReportError("Expecting statement!");
+            return nullptr;
     }
 }
 
 // Rule: Designator ':=' Expression
-std::shared_ptr<ASTNode> Parser::ParseAssignment(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left) { 
+ASTNode* Parser::ParseAssignment(unsigned int pos, ASTNode* left) { 
     m_Lexer->Advance();
     auto right = ParseExpression();
-    return ASTNode::MakeAssignmentNode(line, col, left, right);
+    return ASTNode::MakeAssignmentNode(*m_Arena, pos, left, right);
 }
 
 // Rule: Designator [ActualParameters ]
-std::shared_ptr<ASTNode> Parser::ParseProcedureCall(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left) {
+ASTNode* Parser::ParseProcedureCall(unsigned int pos, ASTNode* left) {
     auto right = ParseActualParameters();
-    return ASTNode::MakeProcedureCallNode(line, col, left, right);
+    return ASTNode::MakeProcedureCallNode(*m_Arena, pos, left, right);
 }
 
 // Rule: Statement { [ ';' ] Statement }
-std::shared_ptr<ASTNode> Parser::ParseStatementSequence() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    nodes->push_back(ParseStatement());
-    while (bool isLock = true) {
+ASTNode* Parser::ParseStatementSequence() { 
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NodeStack.size();
+    auto start = m_Lexer->GetIndex();
+    m_NodeStack.push_back(ParseStatement());
+    if (m_IsPanicking) Synchronize(start);
+    bool isLock = true;
+    while (isLock) {
         if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance(); // Optional semicolon between statements!
+        start = m_Lexer->GetIndex();
         switch (m_Lexer->GetSymbol()) {
             case T_IF:
             case T_CASE:
@@ -728,143 +740,146 @@ std::shared_ptr<ASTNode> Parser::ParseStatementSequence() {
             case T_PROCEDURE:
             case T_PROC:
             case T_LEFTPAREN:
-                nodes->push_back(ParseStatement());
+                m_NodeStack.push_back(ParseStatement());
+                if (m_IsPanicking) Synchronize(start);
+                break;
+            case T_SEMICOLON:
+                ReportError("Unexpected ';' !");
+                m_IsPanicking = false; // Nothing to skip, the next ';' is taken as the separator
                 break;
-            case T_SEMICOLON:   throw SyntaxError(m_Lexer->GetLine(), m_Lexer->GetColumn(), "Unexpected ';' !");
             default:    isLock = false;
         }
     }
 
-    return ASTNode::MakeStatementSequenceNode(line, col, nodes);
+    return ASTNode::MakeStatementSequenceNode(*m_Arena, pos, TakeNodes(mark));
 }
 
 // Rule: 'IF' Expression 'THEN' StatementSequence { 'ELSIF' Expression 'THEN' StatementSequence } [ 'ELSE' StatementSequence ] 'END'
-std::shared_ptr<ASTNode> Parser::ParseIfStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseIfStatement() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
     auto left = ParseExpression();
     CheckSymbolAndAdvance(T_THEN, "Expecting 'THEN' in 'IF' statement!");
     auto right = ParseStatementSequence();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>(); // 'ELSIF'
-    while (m_Lexer->GetSymbol() == T_ELSIF) nodes->push_back(ParseElsifStatement());
+    auto mark = m_NodeStack.size(); // 'ELSIF'
+    while (m_Lexer->GetSymbol() == T_ELSIF) m_NodeStack.push_back(ParseElsifStatement());
     auto next = m_Lexer->GetSymbol() == T_ELSE ? ParseElseStatement() : nullptr;
     CheckSymbolAndAdvance(T_END, "Expecting 'END' at end of 'IF' statement!");
-    return ASTNode::MakeIfStatementNode(line, col, left, right, nodes, next); 
+    return ASTNode::MakeIfStatementNode(*m_Arena, pos, left, right, TakeNodes(mark), next); 
 }
 
 // Rule: 'ELSIF' Expression 'THEN' StatementSequence
-std::shared_ptr<ASTNode> Parser::ParseElsifStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseElsifStatement() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
     auto left = ParseExpression();
     CheckSymbolAndAdvance(T_THEN, "Expecting 'THEN' in 'ELSIF' statement!");
     auto right = ParseStatementSequence();
-    return ASTNode::MakeElsifStatementNode(line, col, left, right);
+    return ASTNode::MakeElsifStatementNode(*m_Arena, pos, left, right);
 }
 
 // Rule: 'ELSE' StatementSequence
-std::shared_ptr<ASTNode> Parser::ParseElseStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseElseStatement() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
     auto right = ParseStatementSequence();
-    return ASTNode::MakeElseStatementNode(line, col, right); 
+    return ASTNode::MakeElseStatementNode(*m_Arena, pos, right); 
 }
 
 // Rule: 'CASE' Expression 'OF' Case { '|' Case } [ 'ELSE' StatementSequence ] 'END'
-std::shared_ptr<ASTNode> Parser::ParseCaseStatement() {
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseCaseStatement() {
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
     auto left = ParseExpression();
     CheckSymbolAndAdvance(T_OF, "Expecting 'OF' in 'CASE' Statement!");
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    nodes->push_back(ParseCase());
+    auto mark = m_NodeStack.size();
+    m_NodeStack.push_back(ParseCase());
     while (m_Lexer->GetSymbol() == T_BAR) {
         m_Lexer->Advance();
-        nodes->push_back(ParseCase());
+        m_NodeStack.push_back(ParseCase());
     }
     auto right = m_Lexer->GetSymbol() == T_ELSE ? ParseElseStatement() : nullptr;
     CheckSymbolAndAdvance(T_END, "Expecting 'END' at end of 'CASE' Statement!");
-    return ASTNode::MakeCaseStatementNode(line, col, left, nodes, right);
+    return ASTNode::MakeCaseStatementNode(*m_Arena, pos, left, TakeNodes(mark), right);
 }
 
 // Rule: [ CaseLabel ':' StatementSequence ]
-std::shared_ptr<ASTNode> Parser::ParseCase() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseCase() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseCaseLabelList();
     CheckSymbolAndAdvance(T_COLON, "Expecting ':' in 'CASE' Statement!");
     auto right = ParseStatementSequence();
-    return ASTNode::MakeCaseStatement(line, col, left, right); 
+    return ASTNode::MakeCaseStatement(*m_Arena, pos, left, right); 
 }
 
 // Rule: CaseLabel { ',' Case Label }
-std::shared_ptr<ASTNode> Parser::ParseCaseLabelList() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    nodes->push_back(ParseLabelRange());
+ASTNode* Parser::ParseCaseLabelList() { 
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NodeStack.size();
+    m_NodeStack.push_back(ParseLabelRange());
     while (m_Lexer->GetSymbol() == T_COMMA) {
         m_Lexer->Advance();
-        nodes->push_back(ParseLabelRange());
+        m_NodeStack.push_back(ParseLabelRange());
     }
-    return ASTNode::MakeCaseLabelRangeNode(line, col, nodes); 
+    return ASTNode::MakeCaseLabelRangeNode(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 // Rule: Label [ '..' Label ]
-std::shared_ptr<ASTNode> Parser::ParseLabelRange() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseLabelRange() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseConstExpression();
     if (m_Lexer->GetSymbol() == T_UPTO) {
         m_Lexer->Advance();
         auto right = ParseConstExpression();
-        return ASTNode::MakeLabelRangeNode(line, col, left, right);
+        return ASTNode::MakeLabelRangeNode(*m_Arena, pos, left, right);
     }
     return left; 
 }
 
 // Rule: 'WHILE' Expression 'DO' StatementSequence { 'ELSIF' Expression 'DO' StatementSequence } 'END'
-std::shared_ptr<ASTNode> Parser::ParseWhileStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseWhileStatement() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
     auto left = ParseExpression();
     CheckSymbolAndAdvance(T_DO, "Expecting 'DO' in 'WHILE' statement!");
     auto right = ParseStatementSequence();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>(); // 'ELSIF'
-    while (m_Lexer->GetSymbol() == T_ELSIF) nodes->push_back(ParseElsifStatement2());
+    auto mark = m_NodeStack.size(); // 'ELSIF'
+    while (m_Lexer->GetSymbol() == T_ELSIF) m_NodeStack.push_back(ParseElsifStatement2());
     CheckSymbolAndAdvance(T_END, "Expecting 'END' at end of 'WHILE' statement!");
-    return ASTNode::MakeWhileStatementNode(line, col, left, right, nodes); 
+    return ASTNode::MakeWhileStatementNode(*m_Arena, pos, left, right, TakeNodes(mark)); 
 }
 
 // Rule: 'ELSIF' Expression 'DO' StatementSequence
-std::shared_ptr<ASTNode> Parser::ParseElsifStatement2() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseElsifStatement2() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
     auto left = ParseExpression();
     CheckSymbolAndAdvance(T_DO, "Expecting 'DO' in 'ELSIF' statement!");
     auto right = ParseStatementSequence();
-    return ASTNode::MakeElsifStatementNode(line, col, left, right);
+    return ASTNode::MakeElsifStatementNode(*m_Arena, pos, left, right);
 }
 
 // Rule: 'REPEAT' StatementSequence 'UNTIL' Expression
-std::shared_ptr<ASTNode> Parser::ParseRepeatStatement() {
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseRepeatStatement() {
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
     auto left = ParseStatementSequence();
     CheckSymbolAndAdvance(T_UNTIL, "Expected 'UNTIL'!");
     auto right = ParseExpression();
-    return ASTNode::MakeRepeatStatementNode(line, col, left, right); 
+    return ASTNode::MakeRepeatStatementNode(*m_Arena, pos, left, right); 
 }
 
 // Rule: 'FOR' ident ':=' Expression 'TO' Expression [ 'BY' ConstExpression ] 'DO' StatementSequence 'END' 
-std::shared_ptr<ASTNode> Parser::ParseForStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseForStatement() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
-    CheckSymbol(T_IDENT, "Expecting literal name in 'FOR' Statement!");
-    auto literalText = m_Lexer->GetText();
+    auto name = CheckName("Expecting literal name in 'FOR' Statement!");
     m_Lexer->Advance();
     CheckSymbolAndAdvance(T_ASSIGN, "Expecting ':=' in 'FOR' Statement!");
     auto left = ParseExpression(); 
     CheckSymbolAndAdvance(T_TO, "Missing 'TO' in 'FOR' Statement!");
     auto right = ParseExpression();
-    std::shared_ptr<ASTNode> next = nullptr;
+    ASTNode* next = nullptr;
     if (m_Lexer->GetSymbol() == T_BY) {
         m_Lexer->Advance();
         next = ParseConstExpression();
@@ -872,70 +887,77 @@ std::shared_ptr<ASTNode> Parser::ParseForStatement() {
     CheckSymbolAndAdvance(T_DO, "Expecting 'DO' in 'FOR' Statement!");
     auto seq = ParseStatementSequence();
     CheckSymbolAndAdvance(T_END, "Expecting 'END' in 'FOR' Statement!");
-    return ASTNode::MakeForStatementNode(line, col, literalText, left, right, next, seq); 
+    return ASTNode::MakeForStatementNode(*m_Arena, pos, name, left, right, next, seq); 
 }
 
 // Rule: 'WITH' Guard 'DO' StatementSequence { '|' Guard 'DO' StatementSequence } [ 'ELSE' StatementSequence ] 'END'
-std::shared_ptr<ASTNode> Parser::ParseWithStatement() {
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto GuardNodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    auto StatementBlockNodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
+ASTNode* Parser::ParseWithStatement() {
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NodeStack.size(); // Guard and StatementSequence pairs
     m_Lexer->Advance(); // 'WITH'
-    GuardNodes->push_back(ParseGuard());
+    m_NodeStack.push_back(ParseGuard());
     CheckSymbolAndAdvance(T_DO, "Expecting 'DO' in 'WITH' Statement!");
-    StatementBlockNodes->push_back(ParseStatementSequence());
+    m_NodeStack.push_back(ParseStatementSequence());
     while (m_Lexer->GetSymbol() == T_BAR) {
         m_Lexer->Advance();
-        GuardNodes->push_back(ParseGuard());
+        m_NodeStack.push_back(ParseGuard());
         CheckSymbolAndAdvance(T_DO, "Expecting 'DO' in 'WITH' Statement!");
-        StatementBlockNodes->push_back(ParseStatementSequence());
+        m_NodeStack.push_back(ParseStatementSequence());
     }
     auto elsePart = m_Lexer->GetSymbol() == T_ELSE ? ParseElseStatement() : nullptr;
     CheckSymbolAndAdvance(T_END, "Expecting 'END' at end of 'WITH' Statement!");
-    return ASTNode::WithStatementNode(line, col, GuardNodes, StatementBlockNodes, elsePart); 
+    // Unzip the pairs, the arena lists are written in place so no temporary vectors are needed.
+    size_t count = (m_NodeStack.size() - mark) / 2;
+    auto guards = static_cast<ASTNode**>(m_Arena->Allocate(sizeof(ASTNode*) * count * 2, alignof(ASTNode*)));
+    auto blocks = guards + count;
+    for (size_t i = 0; i < count; i++) {
+        guards[i] = m_NodeStack[mark + i * 2];
+        blocks[i] = m_NodeStack[mark + i * 2 + 1];
+    }
+    m_NodeStack.resize(mark);
+    return ASTNode::WithStatementNode(*m_Arena, pos, ASTNodeList(guards, count), ASTNodeList(blocks, count), elsePart); 
 }
 
 // Rule: Qualident ':' Qualident
-std::shared_ptr<ASTNode> Parser::ParseGuard() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseGuard() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseQualident();
     CheckSymbolAndAdvance(T_COLON, "Expecting ':' in guard part of 'WITH' Statement!");
     auto right = ParseQualident();
-    return ASTNode::GuardNode(line, col, left, right); 
+    return ASTNode::GuardNode(*m_Arena, pos, left, right); 
 }
 
 // Rule: 'LOOP' StatementSequence 'END'
-std::shared_ptr<ASTNode> Parser::ParseLoopStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseLoopStatement() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
     auto right = ParseStatementSequence();
     CheckSymbolAndAdvance(T_END, "Expecting 'END' at end of 'LOOP' Statement!");
-    return ASTNode::MakeLoopStatementNode(line, col, right); 
+    return ASTNode::MakeLoopStatementNode(*m_Arena, pos, right); 
 }
 
 // Rule: 'EXIT'
-std::shared_ptr<ASTNode> Parser::ParseExitStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseExitStatement() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
-    return ASTNode::MakeExitStatementNode(line, col); 
+    return ASTNode::MakeExitStatementNode(*m_Arena, pos); 
 }
 
 // Rule: ProcedureHeading [ ';' ] ProcedureBody 'END' ident 
-std::shared_ptr<ASTNode> Parser::ParseProcedureDeclaration() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseProcedureDeclaration() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseProcedureHeading();
     if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
     auto right = ParseProcedureBody();
     CheckSymbolAndAdvance(T_END, "Expecting 'END' in 'PROCEDURE' or 'PROC' declaration!");
-    CheckSymbol(T_IDENT, "Missing name literal at end of 'PROCEDURE' or 'PROC' declaration!");
-    auto name = m_Lexer->GetText();
+    auto name = CheckName("Missing name literal at end of 'PROCEDURE' or 'PROC' declaration!");
     m_Lexer->Advance();
-    return ASTNode::MakeProcedureDeclarationNode(line, col, left, right, name); 
+    return ASTNode::MakeProcedureDeclarationNode(*m_Arena, pos, left, right, name); 
 }
 
 // Rule: ( 'PROCEDURE' | 'PROC' ) [ Reciver ] IdentDef [ FormalParameters ]
-std::shared_ptr<ASTNode> Parser::ParseProcedureHeading() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseProcedureHeading() { 
+    auto pos = m_Lexer->GetOffset();
     auto isProc = false;
     if (m_Lexer->GetSymbol() == T_PROCEDURE) m_Lexer->Advance();
     else {
@@ -945,12 +967,12 @@ std::shared_ptr<ASTNode> Parser::ParseProcedureHeading() {
     auto reciver = m_Lexer->GetSymbol() == T_LEFTPAREN ? ParseReciver() : nullptr;
     auto name = ParseIdentDef();
     auto formal = m_Lexer->GetSymbol() == T_LEFTPAREN ? ParseFormalParameters() : nullptr;
-    return ASTNode::MakeProcedureHeading(line, col, isProc, reciver, name, formal); 
+    return ASTNode::MakeProcedureHeading(*m_Arena, pos, isProc, reciver, name, formal); 
 }
 
 // Rule: '(' [ 'VAR' | 'IN' ] ident ':' ident ')'
-std::shared_ptr<ASTNode> Parser::ParseReciver() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseReciver() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance(); // '(')
     bool isVar = false, isIn = false;
     if (m_Lexer->GetSymbol() == T_VAR) {
@@ -962,41 +984,39 @@ std::shared_ptr<ASTNode> Parser::ParseReciver() {
         isIn = true;
     }
    
-    CheckSymbol(T_IDENT, "Expecting name literal in reciver's first column!");
-    auto left = m_Lexer->GetText();
+    auto left = CheckName("Expecting name literal in reciver's first column!");
     m_Lexer->Advance();
    
     CheckSymbolAndAdvance(T_COLON, "Expecting ':' in reciver!");
    
-    CheckSymbol(T_IDENT, "Expecting name literal in reciver's first column!");
-    auto right = m_Lexer->GetText();
+    auto right = CheckName("Expecting name literal in reciver's first column!");
     m_Lexer->Advance();
 
     CheckSymbolAndAdvance(T_RIGHTPAREN, "Expecting ')' in reciver!");
-    return ASTNode::MakeReciverNode(line, col, left, right); 
+    return ASTNode::MakeReciverNode(*m_Arena, pos, left, right, isVar, isIn); 
 }
 
 // Rule: DeclarationSequence [ 'BEGIN' StatementSequence | 'returnStatement [ ';' ] ]
-std::shared_ptr<ASTNode> Parser::ParseProcedureBody() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseProcedureBody() { 
+    auto pos = m_Lexer->GetOffset();
     auto left = ParseDeclarationSequence(false);
-    std::shared_ptr<ASTNode> right = nullptr;
+    ASTNode* right = nullptr;
     if (m_Lexer->GetSymbol() == T_BEGIN) {
         m_Lexer->Advance();
         right = ParseStatementSequence();
     }
-    else {
+    else if (m_Lexer->GetSymbol() == T_RETURN) {
         right = ParseReturnStatement();
         if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
     }
-    return ASTNode::MakeProcedureBodyNode(line, col, left, right); 
+    return ASTNode::MakeProcedureBodyNode(*m_Arena, pos, left, right); 
 }
 
 // Rule: 'RETURN' [ Expression ]
-std::shared_ptr<ASTNode> Parser::ParseReturnStatement() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseReturnStatement() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance();
-    std::shared_ptr<ASTNode> right = nullptr;
+    ASTNode* right = nullptr;
     switch (m_Lexer->GetSymbol()) {
         case T_SEMICOLON:
         case T_END:
@@ -1016,31 +1036,31 @@ std::shared_ptr<ASTNode> Parser::ParseReturnStatement() {
             right = ParseExpression();
 
     }
-    return ASTNode::MakeReturnStatementNode(line, col, right); 
+    return ASTNode::MakeReturnStatementNode(*m_Arena, pos, right); 
 }
 
 // Rule: '(' FPSection { [ ';' ] FPSection } ')'
-std::shared_ptr<ASTNode> Parser::ParseFormalParameters() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseFormalParameters() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance(); // '('
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    nodes->push_back(ParseFPSection());
-    while (m_Lexer->GetSymbol() != T_RIGHTPAREN) {
+    auto mark = m_NodeStack.size();
+    m_NodeStack.push_back(ParseFPSection());
+    while (m_Lexer->GetSymbol() != T_RIGHTPAREN && !m_IsPanicking) {
         if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
-        nodes->push_back(ParseFPSection());
+        m_NodeStack.push_back(ParseFPSection());
     }
-    m_Lexer->Advance(); // ')'
-    return ASTNode::MakeFormalParametersNode(line, col, nodes); 
+    CheckSymbolAndAdvance(T_RIGHTPAREN, "Expecting ')' in formal parameters!");
+    return ASTNode::MakeFormalParametersNode(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 // Rule: Type
-std::shared_ptr<ASTNode> Parser::ParseReturnType() { 
+ASTNode* Parser::ParseReturnType() { 
     return ParseType(); // Possible remove this rule later! 
 }
 
 // Rule: [ 'VAR' | 'IN' ] ident { [ ',' ] ident } ':' FormalType
-std::shared_ptr<ASTNode> Parser::ParseFPSection() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseFPSection() { 
+    auto pos = m_Lexer->GetOffset();
     bool isVar = false, isIn = false;
     if (m_Lexer->GetSymbol() == T_VAR) {
         m_Lexer->Advance();
@@ -1050,156 +1070,156 @@ std::shared_ptr<ASTNode> Parser::ParseFPSection() {
         m_Lexer->Advance();
         isIn = true;
     }
-    auto nodes = std::make_shared<std::vector<std::string>>();
-    nodes->push_back(m_Lexer->GetText());
+    auto mark = m_NameStack.size();
+    m_NameStack.push_back(CheckName("Expecting literal name in arguments!"));
     m_Lexer->Advance();
-    while (m_Lexer->GetSymbol() != T_COLON) {
+    while (m_Lexer->GetSymbol() != T_COLON && !m_IsPanicking) {
         if (m_Lexer->GetSymbol() == T_COMMA) m_Lexer->Advance();
-        CheckSymbol(T_IDENT, "Expecting literal name in arguments!");
-        nodes->push_back(m_Lexer->GetText());
+        m_NameStack.push_back(CheckName("Expecting literal name in arguments!"));
         m_Lexer->Advance();
     }
-    m_Lexer->Advance(); // ':'
+    CheckSymbolAndAdvance(T_COLON, "Expecting ':' in arguments!");
     auto formalType = ParseFormalType();
-    return ASTNode::MakeFPSectionNode(line, col, nodes, formalType, isVar, isIn); 
+    return ASTNode::MakeFPSectionNode(*m_Arena, pos, TakeNames(mark), formalType, isVar, isIn); 
 }
 
 // Rule: Type
-std::shared_ptr<ASTNode> Parser::ParseFormalType() { 
+ASTNode* Parser::ParseFormalType() { 
     return ParseType(); // ossible remove this rule later! 
 }
 
 // Rule: 'MODULE' Ident [ TypeParams ] [ ';' ] { ImportSequence | DeclarationSequence } [ 'BEGIN' StatementSequence ] 'END' Ident [ '.' ]
-std::shared_ptr<ASTNode> Parser::ParseModule() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseModule() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance(); // 'MODULE'
-    CheckSymbol(T_IDENT, "Name of module is missing!");
-    auto moduleText = m_Lexer->GetText();
+    auto moduleName = CheckName("Name of module is missing!");
     m_Lexer->Advance();
     auto typeParams = m_Lexer->GetSymbol() == T_LEFTPAREN ? ParseTypeParams() : nullptr;
     if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance(); // Optional ';'
 
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    while (bool isLock = true) {
+    auto mark = m_NodeStack.size();
+    bool isLock = true;
+    while (isLock) {
+        auto start = m_Lexer->GetIndex();
         switch (m_Lexer->GetSymbol()) {
-            case T_IMPORT:  nodes->push_back(ParseImportList()); break;
+            case T_IMPORT:
+                m_NodeStack.push_back(ParseImportList());
+                if (m_IsPanicking) Synchronize(start);
+                break;
             case T_CONST:
             case T_TYPE:
             case T_VAR:
             case T_PROCEDURE:
             case T_PROC:
             case T_LEFTPAREN:
-                nodes->push_back(ParseDeclarationSequence());
+                m_NodeStack.push_back(ParseDeclarationSequence(false));
                 break;
             default:    isLock = false;
         }
     }
 
-    std::shared_ptr<ASTNode> block = nullptr;
+    ASTNode* block = nullptr;
     if (m_Lexer->GetSymbol() == T_BEGIN) {
         m_Lexer->Advance();
         block = ParseStatementSequence();
     }
 
     CheckSymbolAndAdvance(T_END, "Expecting 'END' at end of module!");
-    CheckSymbol(T_IDENT, "Missing module name at end of module!");
-    if (moduleText != m_Lexer->GetText()) throw SyntaxError(m_Lexer->GetLine(), m_Lexer->GetColumn(), "Module name is inconsistant in module!");
+    if (moduleName != CheckName("Missing module name at end of module!")) ReportError("Module name is inconsistant in module!");
     m_Lexer->Advance();
 
     if (m_Lexer->GetSymbol() == T_DOT) m_Lexer->Advance(); // optional '.' at end of module
-    if (m_Lexer->GetSymbol() != T_EOF) throw SyntaxError(m_Lexer->GetLine(), m_Lexer->GetColumn(), "Expecting End of file!");
+    if (m_Lexer->GetSymbol() != T_EOF) ReportError("Expecting End of file!");
 
-    return ASTNode::MakeModuleNode(line, col, moduleText, typeParams, nodes, block); 
+    return ASTNode::MakeModuleNode(*m_Arena, pos, moduleName, typeParams, TakeNodes(mark), block); 
 }
 
 // Rule: 'IMPORT' Import { [ ', '  Import ] } [ ';' ] 
-std::shared_ptr<ASTNode> Parser::ParseImportList() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseImportList() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance(); // 'IMPORT'
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    nodes->push_back(ParseImport());
+    auto mark = m_NodeStack.size();
+    m_NodeStack.push_back(ParseImport());
     while (m_Lexer->GetSymbol() == T_COMMA) {
         m_Lexer->Advance();
-        nodes->push_back(ParseImport());
+        m_NodeStack.push_back(ParseImport());
     }
     if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
 
-    return ASTNode::MakeImportListNode(line, col, nodes); 
+    return ASTNode::MakeImportListNode(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 // Rule:
-std::shared_ptr<ASTNode> Parser::ParseImport() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    CheckSymbol(T_IDENT, "Expecting name of 'IMPORT' statement!");
-    auto queryText = m_Lexer->GetText();
+ASTNode* Parser::ParseImport() { 
+    auto pos = m_Lexer->GetOffset();
+    auto queryName = CheckName("Expecting name of 'IMPORT' statement!");
     m_Lexer->Advance();
     if (m_Lexer->GetSymbol() == T_ASSIGN) {
-        auto left = queryText;
+        auto left = queryName;
         m_Lexer->Advance();
-        CheckSymbol(T_IDENT, "Expecting name literal after ':=' in import Statement!");
-        queryText = m_Lexer->GetText();
+        queryName = CheckName("Expecting name literal after ':=' in import Statement!");
         m_Lexer->Advance();
-        auto right = queryText;
+        auto right = queryName;
         if (m_Lexer->GetSymbol() == T_DOT) {
             m_Lexer->Advance();
-            CheckSymbol(T_IDENT, "Expecting name literal after '.' in import Statement!");
-            auto next = m_Lexer->GetText();
+            auto next = CheckName("Expecting name literal after '.' in import Statement!");
             m_Lexer->Advance();
             auto last = m_Lexer->GetSymbol() == T_LEFTPAREN ? ParseTypeActuals() : nullptr;
-            return ASTNode::MakeImportAssignPathNode(line, col, left, right, next, last);
+            return ASTNode::MakeImportAssignPathNode(*m_Arena, pos, left, right, next, last);
         }
         else {
             auto next = m_Lexer->GetSymbol() == T_LEFTPAREN ? ParseTypeActuals() : nullptr;
-            return ASTNode::MakeImportAssignNode(line, col, left, right, next);
+            return ASTNode::MakeImportAssignNode(*m_Arena, pos, left, right, next);
         }
     }
     else if (m_Lexer->GetSymbol() == T_DOT) { // ImportPath
-        auto left = queryText;
+        auto left = queryName;
         m_Lexer->Advance();
-        CheckSymbol(T_IDENT, "Expecting name literal after '.' in import Statement!");
-        auto right = m_Lexer->GetText();
+        auto right = CheckName("Expecting name literal after '.' in import Statement!");
         m_Lexer->Advance();
         auto next = m_Lexer->GetSymbol() == T_LEFTPAREN ? ParseTypeActuals() : nullptr;
-        return ASTNode::MakeImportPathNode(line, col, left, right, next);
+        return ASTNode::MakeImportPathNode(*m_Arena, pos, left, right, next);
     }
     else {
-        auto left = queryText;
+        auto left = queryName;
         auto right = m_Lexer->GetSymbol() == T_LEFTPAREN ? ParseTypeActuals() : nullptr;
-        return ASTNode::MakeImportNode(line, col, left, right);
+        return ASTNode::MakeImportNode(*m_Arena, pos, left, right);
     }
 }
 
 
 // Rule: 'DEFINITION' Ident [ ';' ] [ ImportList ] DeclarationSequence2 'END' Ident [ '.' ]
-std::shared_ptr<ASTNode> Parser::ParseDefinition() { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
+ASTNode* Parser::ParseDefinition() { 
+    auto pos = m_Lexer->GetOffset();
     m_Lexer->Advance(); // 'DEFINITION'
-    CheckSymbol(T_IDENT, "Missing definition name!");
-    auto defName = m_Lexer->GetText();
+    auto defName = CheckName("Missing definition name!");
     m_Lexer->Advance();
     auto left = m_Lexer->GetSymbol() == T_IMPORT ? ParseImportList() : nullptr;
     auto right = ParseDeclarationSequence();
     CheckSymbolAndAdvance(T_END, "Expecting 'END' in defintion!");
-    CheckSymbol(T_IDENT, "Missing ident at end of declaration sequence!");
-    if (defName != m_Lexer->GetText()) throw SyntaxError(m_Lexer->GetLine(), m_Lexer->GetColumn(), "Inconsitant name of definition Sequence!");
+    if (defName != CheckName("Missing ident at end of declaration sequence!")) ReportError("Inconsitant name of definition Sequence!");
     m_Lexer->Advance();
     if (m_Lexer->GetSymbol() == T_DOT) m_Lexer->Advance();
 
-    return ASTNode::MakeDeclarationNode(line, col, defName, left, right); 
+    return ASTNode::MakeDeclarationNode(*m_Arena, pos, defName, left, right); 
 }
 
-// Rule: { CONST { ConstDeclaration [ '; ] } | TYPE { TypeDeclaration [ '; ] } | VAR { VariableDeclaration [ '; ] } | ProcedureHeading [ '; ] }
-std::shared_ptr<ASTNode> Parser::ParseDeclarationSequence(bool isDefinition) { 
-    auto line = m_Lexer->GetLine(); auto col = m_Lexer->GetColumn();
-    auto nodes = std::make_shared<std::vector<std::shared_ptr<ASTNode>>>();
-    while (bool isLock = true) {
+// Rule: { CONST { ConstDeclaration [ '; ] } | TYPE { TypeDeclaration [ '; ] } | VAR { VariableDeclaration [ '; ] } | ( ProcedureHeading | ProcedureDeclaration ) [ '; ] }
+ASTNode* Parser::ParseDeclarationSequence(bool isDefinition) { 
+    auto pos = m_Lexer->GetOffset();
+    auto mark = m_NodeStack.size();
+    bool isLock = true;
+    while (isLock) {
         switch (m_Lexer->GetSymbol()) {
             case T_CONST:
                 {
                     m_Lexer->Advance();
-                    nodes->push_back(ParseConstDeclaration());
+                    auto start = m_Lexer->GetIndex();
+                    m_NodeStack.push_back(ParseConstDeclaration());
+                    if (m_IsPanicking) Synchronize(start);
                     if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
-                    while (bool isLock2 = true) {
+                    bool isLock2 = true;
+                    while (isLock2) {
                         switch (m_Lexer->GetSymbol()) {
                             case T_CONST:
                             case T_TYPE:
@@ -1207,11 +1227,16 @@ std::shared_ptr<ASTNode> Parser::ParseDeclarationSequence(bool isDefinition) {
                             case T_PROCEDURE:
                             case T_PROC:
                             case T_LEFTPAREN:
+                            case T_BEGIN:
+                            case T_RETURN:
                             case T_END:
+                            case T_EOF:
                                 isLock2 = false;
                                 break;
                             default:
-                                nodes->push_back(ParseConstDeclaration());
+                                start = m_Lexer->GetIndex();
+                                m_NodeStack.push_back(ParseConstDeclaration());
+                                if (m_IsPanicking) Synchronize(start);
                                 if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
                         }
                     }
@@ -1220,9 +1245,12 @@ std::shared_ptr<ASTNode> Parser::ParseDeclarationSequence(bool isDefinition) {
             case T_TYPE:
                 {
                     m_Lexer->Advance();
-                    nodes->push_back(ParseTypeDeclaration());
+                    auto start = m_Lexer->GetIndex();
+                    m_NodeStack.push_back(ParseTypeDeclaration());
+                    if (m_IsPanicking) Synchronize(start);
                     if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
-                    while (bool isLock2 = true) {
+                    bool isLock2 = true;
+                    while (isLock2) {
                         switch (m_Lexer->GetSymbol()) {
                             case T_CONST:
                             case T_TYPE:
@@ -1230,11 +1258,16 @@ std::shared_ptr<ASTNode> Parser::ParseDeclarationSequence(bool isDefinition) {
                             case T_PROCEDURE:
                             case T_PROC:
                             case T_LEFTPAREN:
+                            case T_BEGIN:
+                            case T_RETURN:
                             case T_END:
+                            case T_EOF:
                                 isLock2 = false;
                                 break;
                             default:
-                                nodes->push_back(ParseTypeDeclaration());
+                                start = m_Lexer->GetIndex();
+                                m_NodeStack.push_back(ParseTypeDeclaration());
+                                if (m_IsPanicking) Synchronize(start);
                                 if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
                         }
                     }
@@ -1243,9 +1276,12 @@ std::shared_ptr<ASTNode> Parser::ParseDeclarationSequence(bool isDefinition) {
             case T_VAR:
                 {
                     m_Lexer->Advance();
-                    nodes->push_back(ParseVariableDeclararation());
+                    auto start = m_Lexer->GetIndex();
+                    m_NodeStack.push_back(ParseVariableDeclararation());
+                    if (m_IsPanicking) Synchronize(start);
                     if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
-                    while (bool isLock2 = true) {
+                    bool isLock2 = true;
+                    while (isLock2) {
                         switch (m_Lexer->GetSymbol()) {
                             case T_CONST:
                             case T_TYPE:
@@ -1253,11 +1289,16 @@ std::shared_ptr<ASTNode> Parser::ParseDeclarationSequence(bool isDefinition) {
                             case T_PROCEDURE:
                             case T_PROC:
                             case T_LEFTPAREN:
+                            case T_BEGIN:
+                            case T_RETURN:
                             case T_END:
+                            case T_EOF:
                                 isLock2 = false;
                                 break;
                             default:
-                                nodes->push_back(ParseVariableDeclararation());
+                                start = m_Lexer->GetIndex();
+                                m_NodeStack.push_back(ParseVariableDeclararation());
+                                if (m_IsPanicking) Synchronize(start);
                                 if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
                         }
                     }
@@ -1266,30 +1307,109 @@ std::shared_ptr<ASTNode> Parser::ParseDeclarationSequence(bool isDefinition) {
             case T_PROCEDURE:
             case T_PROC:
             case T_LEFTPAREN:
-                nodes->push_back(ParseProcedureHeading());
-                if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
+                {
+                    auto start = m_Lexer->GetIndex();
+                    m_NodeStack.push_back(isDefinition ? ParseProcedureHeading() : ParseProcedureDeclaration());
+                    if (m_IsPanicking) Synchronize(start);
+                    if (m_Lexer->GetSymbol() == T_SEMICOLON) m_Lexer->Advance();
+                }
                 break;
             default:
                 isLock = false;
         }
     }
 
-    return ASTNode::MakeDeclarationSequence2Node(line, col, nodes); 
+    return ASTNode::MakeDeclarationSequence2Node(*m_Arena, pos, TakeNodes(mark)); 
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // UTILITIES //////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Parser::CheckSymbol(TokenCode symbol, std::string msg) {
-    if (m_Lexer->GetSymbol() != symbol) {
-        throw std::make_shared<SyntaxError>(m_Lexer->GetLine(), m_Lexer->GetColumn(), msg);
+// Moves the children pushed on the node stack since mark into the arena. Rules that failed in
+// recovery mode give back no node, those are left out.
+ASTNodeList Parser::TakeNodes(size_t mark) {
+    if (!m_Diagnostics.empty()) m_NodeStack.erase(std::remove(m_NodeStack.begin() + mark, m_NodeStack.end(), nullptr), m_NodeStack.end());
+    auto list = m_Arena->MakeList(m_NodeStack.data() + mark, m_NodeStack.size() - mark);
+    m_NodeStack.resize(mark);
+    return list;
+}
+
+AtomList Parser::TakeNames(size_t mark) {
+    auto list = m_Arena->MakeList(m_NameStack.data() + mark, m_NameStack.size() - mark);
+    m_NameStack.resize(mark);
+    return list;
+}
+
+void Parser::CheckSymbol(TokenCode symbol, const char* msg) {
+    if (m_Lexer->GetSymbol() != symbol) ReportError(msg);
+}
+
+// Returns the name of the current identifier. A missing name is NO_ATOM, whatever token is there
+// instead, so a recovered tree never holds a name the source does not contain.
+Atom Parser::CheckName(const char* msg) {
+    if (m_Lexer->GetSymbol() != T_IDENT) {
+        ReportError(msg);
+        return NO_ATOM;
     }
+    return m_Lexer->GetAtom();
 }
 
-void Parser::CheckSymbolAndAdvance(TokenCode symbol, std::string msg) {
+// A missing symbol is taken as if it was there, the current token is left for the rule after it.
+void Parser::CheckSymbolAndAdvance(TokenCode symbol, const char* msg) {
     if (m_Lexer->GetSymbol() != symbol) {
-        throw std::make_shared<SyntaxError>(m_Lexer->GetLine(), m_Lexer->GetColumn(), msg);
+        ReportError(msg);
+        return;
     }
     m_Lexer->Advance();
-}
\ No newline at end of file
+}
+
+// Throws unless recovering. In panic mode the error follows from one already reported and is dropped.
+void Parser::ReportError(const char* msg) {
+    if (!m_IsRecovering) throw SyntaxError(m_Lexer->GetLine(), m_Lexer->GetColumn(), msg);
+    if (!m_IsPanicking) m_Diagnostics.emplace_back(m_Lexer->GetLine(), m_Lexer->GetColumn(), msg);
+    m_IsPanicking = true;
+}
+
+// Ends panic mode after the item that started at token index start. Skips at least one token if the
+// item took none, then up to the next symbol a statement or declaration list can go on from. A ';'
+// ends the broken item and is skipped with it.
+void Parser::Synchronize(size_t start) {
+    if (m_Lexer->GetIndex() == start) m_Lexer->Advance();
+    bool isLock = true;
+    while (isLock) {
+        switch (m_Lexer->GetSymbol()) {
+            case T_SEMICOLON:
+                m_Lexer->Advance();
+                isLock = false;
+                break;
+            case T_END:
+            case T_ELSIF:
+            case T_ELSE:
+            case T_UNTIL:
+            case T_BAR:
+            case T_IF:
+            case T_CASE:
+            case T_WITH:
+            case T_LOOP:
+            case T_EXIT:
+            case T_RETURN:
+            case T_WHILE:
+            case T_REPEAT:
+            case T_FOR:
+            case T_BEGIN:
+            case T_IMPORT:
+            case T_CONST:
+            case T_TYPE:
+            case T_VAR:
+            case T_PROCEDURE:
+            case T_PROC:
+            case T_EOF:
+                isLock = false;
+                break;
+            default:
+                m_Lexer->Advance();
+        }
+    }
+    m_IsPanicking = false;
+}
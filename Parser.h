@@ -1,16 +1,22 @@
 
 #include "Tokenizer.h"
+#include "TokenStream.h"
+#include "ASTArena.h"
 #include "ASTNode.h"
 
 #include <memory>
 #include <string>
 #include <sstream>
+#include <vector>
 
 
 class SyntaxError {
    public:
         SyntaxError(unsigned int line, unsigned int col, std::string text);
-        std::string GetExceptionDetails();
+        std::string GetExceptionDetails() const;
+        unsigned int GetLine() const { return m_Line; }
+        unsigned int GetColumn() const { return m_Col; }
+        const std::string& GetText() const { return m_Text; }
 
     private:
         unsigned int m_Line;
@@ -21,82 +27,114 @@ class SyntaxError {
 class Parser
 {
     public:
-        Parser(std::shared_ptr<Tokenizer> lexer);
+        // The tree is allocated in arena and lives as long as it does, a parser without one makes its own.
+        Parser(std::shared_ptr<Tokenizer> lexer, std::shared_ptr<ASTArena> arena = nullptr);
+        Parser(std::shared_ptr<TokenStream> tokens, std::shared_ptr<ASTArena> arena = nullptr);
 
-        std::shared_ptr<ASTNode> ParseOberon();
+        ASTNode* ParseOberon();
+        // Only the head of the file up to the end of its leading import lists, nothing after them is
+        // lexed. Gives a Module node with just the import lists, or a Definition node with just its
+        // import list, and no body. Lets the CompileDriver order modules before parsing any of them.
+        ASTNode* ParseHeader();
+        // One item of a list of an owner node, parsed the way the loop of ParseModule,
+        // ParseDeclarationSequence or ParseStatementSequence parsed it into that list. Lets the
+        // IncrementalParser parse an edited region on its own.
+        ASTNode* ParseListItem(NodeKind owner, NodeKind item);
+        std::shared_ptr<ASTArena> GetArena() { return m_Arena; }
+
+        // Errors no longer throw SyntaxError, they are collected in GetDiagnostics() and the parse goes
+        // on. After an error the parser is in panic mode: further errors are dropped until the statement
+        // or declaration around it is done and the tokens up to the next ';', END, ELSIF, PROCEDURE or
+        // other synchronising symbol are skipped. Items that failed are left out of their lists, so the
+        // tree is only good for looking at. Must be called before parsing.
+        void EnableRecovery() { m_IsRecovering = true; }
+        bool IsRecovering() const { return m_IsRecovering; }
+        const std::vector<SyntaxError>& GetDiagnostics() const { return m_Diagnostics; }
 
     private:
-        std::shared_ptr<ASTNode> ParseQualident();
-        std::shared_ptr<ASTNode> ParseIdentDef();
-        std::shared_ptr<ASTNode> ParseConstDeclaration();
-        std::shared_ptr<ASTNode> ParseConstExpression();
-        std::shared_ptr<ASTNode> ParseTypeDeclaration();
-        std::shared_ptr<ASTNode> ParseType();
-        std::shared_ptr<ASTNode> ParseNamedType();
-        std::shared_ptr<ASTNode> ParseTypeParams();
-        std::shared_ptr<ASTNode> ParseTypeActuals();
-        std::shared_ptr<ASTNode> ParseEnumeration();
-        std::shared_ptr<ASTNode> ParseArrayType();
-        std::shared_ptr<ASTNode> ParseLengthList();
-        std::shared_ptr<ASTNode> ParseLength();
-        std::shared_ptr<ASTNode> ParseVarLength();
-        std::shared_ptr<ASTNode> ParseRecordType();
-        std::shared_ptr<ASTNode> ParseBaseType();
-        std::shared_ptr<ASTNode> ParseFieldListSequence();
-        std::shared_ptr<ASTNode> ParseFieldList();
-        std::shared_ptr<ASTNode> ParseIdentList();
-        std::shared_ptr<ASTNode> ParsePointerType();
-        std::shared_ptr<ASTNode> ParseProcedureType();
-        std::shared_ptr<ASTNode> ParseVariableDeclararation();
-        std::shared_ptr<ASTNode> ParseDesignator();
-        std::shared_ptr<ASTNode> ParseSelector();
-        std::shared_ptr<ASTNode> ParseExpList();
-        std::shared_ptr<ASTNode> ParseExpression();
-        std::shared_ptr<ASTNode> ParseSimpleExpression();
-        std::shared_ptr<ASTNode> ParseTerm();
-        std::shared_ptr<ASTNode> ParseLiteral();
-        std::shared_ptr<ASTNode> ParseFactor();
-        std::shared_ptr<ASTNode> ParseSet();
-        std::shared_ptr<ASTNode> ParseElement();
-        std::shared_ptr<ASTNode> ParseActualParameters();
-        std::shared_ptr<ASTNode> ParseStatement();
-        std::shared_ptr<ASTNode> ParseAssignment(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left);
-        std::shared_ptr<ASTNode> ParseProcedureCall(unsigned int line, unsigned int col, std::shared_ptr<ASTNode> left);
-        std::shared_ptr<ASTNode> ParseStatementSequence();
-        std::shared_ptr<ASTNode> ParseIfStatement();
-        std::shared_ptr<ASTNode> ParseElsifStatement();
-        std::shared_ptr<ASTNode> ParseElseStatement();
-        std::shared_ptr<ASTNode> ParseCaseStatement();
-        std::shared_ptr<ASTNode> ParseCase();
-        std::shared_ptr<ASTNode> ParseCaseLabelList();
-        std::shared_ptr<ASTNode> ParseLabelRange();
-        std::shared_ptr<ASTNode> ParseWhileStatement();
-        std::shared_ptr<ASTNode> ParseElsifStatement2();
-        std::shared_ptr<ASTNode> ParseRepeatStatement();
-        std::shared_ptr<ASTNode> ParseForStatement();
-        std::shared_ptr<ASTNode> ParseWithStatement();
-        std::shared_ptr<ASTNode> ParseGuard();
-        std::shared_ptr<ASTNode> ParseLoopStatement();
-        std::shared_ptr<ASTNode> ParseExitStatement();
-        std::shared_ptr<ASTNode> ParseProcedureDeclaration();
-        std::shared_ptr<ASTNode> ParseProcedureHeading();
-        std::shared_ptr<ASTNode> ParseReciver();
-        std::shared_ptr<ASTNode> ParseProcedureBody();
-        std::shared_ptr<ASTNode> ParseDeclarationSequence(bool isDefinition = true);
-        std::shared_ptr<ASTNode> ParseReturnStatement();
-        std::shared_ptr<ASTNode> ParseFormalParameters();
-        std::shared_ptr<ASTNode> ParseReturnType();
-        std::shared_ptr<ASTNode> ParseFPSection();
-        std::shared_ptr<ASTNode> ParseFormalType();
-        std::shared_ptr<ASTNode> ParseModule();
-        std::shared_ptr<ASTNode> ParseImportList();
-        std::shared_ptr<ASTNode> ParseImport();
-        std::shared_ptr<ASTNode> ParseDefinition();
+        ASTNode* ParseQualident();
+        ASTNode* ParseIdentDef();
+        ASTNode* ParseConstDeclaration();
+        ASTNode* ParseConstExpression();
+        ASTNode* ParseTypeDeclaration();
+        ASTNode* ParseType();
+        ASTNode* ParseNamedType();
+        ASTNode* ParseTypeParams();
+        ASTNode* ParseTypeActuals();
+        ASTNode* ParseEnumeration();
+        ASTNode* ParseArrayType();
+        ASTNode* ParseLengthList();
+        ASTNode* ParseLength();
+        ASTNode* ParseVarLength();
+        ASTNode* ParseRecordType();
+        ASTNode* ParseBaseType();
+        ASTNode* ParseFieldListSequence();
+        ASTNode* ParseFieldList();
+        ASTNode* ParseIdentList();
+        ASTNode* ParsePointerType();
+        ASTNode* ParseProcedureType();
+        ASTNode* ParseVariableDeclararation();
+        ASTNode* ParseDesignator();
+        ASTNode* ParseSelector();
+        ASTNode* ParseExpList();
+        ASTNode* ParseExpression();
+        ASTNode* ParseOperand(unsigned int level);
+        ASTNode* ParseLiteral();
+        ASTNode* ParseFactor();
+        ASTNode* ParseSet();
+        ASTNode* ParseElement();
+        ASTNode* ParseActualParameters();
+        ASTNode* ParseStatement();
+        ASTNode* ParseAssignment(unsigned int pos, ASTNode* left);
+        ASTNode* ParseProcedureCall(unsigned int pos, ASTNode* left);
+        ASTNode* ParseStatementSequence();
+        ASTNode* ParseIfStatement();
+        ASTNode* ParseElsifStatement();
+        ASTNode* ParseElseStatement();
+        ASTNode* ParseCaseStatement();
+        ASTNode* ParseCase();
+        ASTNode* ParseCaseLabelList();
+        ASTNode* ParseLabelRange();
+        ASTNode* ParseWhileStatement();
+        ASTNode* ParseElsifStatement2();
+        ASTNode* ParseRepeatStatement();
+        ASTNode* ParseForStatement();
+        ASTNode* ParseWithStatement();
+        ASTNode* ParseGuard();
+        ASTNode* ParseLoopStatement();
+        ASTNode* ParseExitStatement();
+        ASTNode* ParseProcedureDeclaration();
+        ASTNode* ParseProcedureHeading();
+        ASTNode* ParseReciver();
+        ASTNode* ParseProcedureBody();
+        ASTNode* ParseDeclarationSequence(bool isDefinition = true);
+        ASTNode* ParseReturnStatement();
+        ASTNode* ParseFormalParameters();
+        ASTNode* ParseReturnType();
+        ASTNode* ParseFPSection();
+        ASTNode* ParseFormalType();
+        ASTNode* ParseModule();
+        ASTNode* ParseImportList();
+        ASTNode* ParseImport();
+        ASTNode* ParseDefinition();
 
-        void CheckSymbol(TokenCode symbol, std::string msg);
-        void CheckSymbolAndAdvance(TokenCode symbol, std::string msg);
+        ASTNodeList TakeNodes(size_t mark);
+        AtomList TakeNames(size_t mark);
+        void CheckSymbol(TokenCode symbol, const char* msg);
+        Atom CheckName(const char* msg);
+        void CheckSymbolAndAdvance(TokenCode symbol, const char* msg);
+        void ReportError(const char* msg);
+        void Synchronize(size_t start);
 
     private:
-        std::shared_ptr<Tokenizer> m_Lexer;
+        std::shared_ptr<TokenStream> m_Lexer;
+        std::shared_ptr<ASTArena> m_Arena;
+        // Children of the lists under construction, a rule pushes on top and takes its range back
+        // when the list is complete, so lists of any nesting need no allocation of their own.
+        std::vector<ASTNode*> m_NodeStack;
+        std::vector<Atom> m_NameStack;
+        bool m_IsRecovering;
+        bool m_IsPanicking;                     // An error was reported and the parser has not synchronised yet
+        std::vector<SyntaxError> m_Diagnostics;
 
 };
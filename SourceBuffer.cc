@@ -0,0 +1,144 @@
+#include "SourceBuffer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+// Zero bytes guaranteed after the mapped text, room for the sentinel and for wide loads near the end.
+static const size_t SENTINEL_PADDING = 64;
+
+SourceBuffer::SourceBuffer() {
+    m_Data = ""; m_Length = 0; m_Map = nullptr; m_MapLength = 0;
+    m_Fd = -1; m_IsFdOwned = false; m_IsExhausted = true; m_IsCutOff = false; m_Base = 0; m_WindowSize = 0;
+}
+
+SourceBuffer::~SourceBuffer() {
+    if (m_Map != nullptr) munmap(m_Map, m_MapLength);
+    if (m_IsFdOwned) close(m_Fd);
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::FromFile(const std::string& fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    /* Pipes, devices and friends have no usable size, stream them instead, and files too long for 32 bit positions */
+    if (!S_ISREG(st.st_mode) || static_cast<unsigned long long>(st.st_size) > MAX_LENGTH) return FromDescriptor(fd, true);
+
+    auto buffer = std::shared_ptr<SourceBuffer>(new SourceBuffer());
+    size_t length = st.st_size;
+    if (length == 0) {
+        close(fd);
+        return buffer;
+    }
+
+    /* Reserve zeroed pages for text plus padding, then map the file over the head of them. The tail of
+       the last file page is zero filled by the kernel and the remaining pages stay anonymous zeros. */
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t mapLength = (length + SENTINEL_PADDING + pageSize - 1) & ~(pageSize - 1);
+    void* base = mmap(nullptr, mapLength, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+    if (mmap(base, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, mapLength);
+        close(fd);
+        return nullptr;
+    }
+    close(fd);
+    madvise(base, length, MADV_SEQUENTIAL);
+
+    buffer->m_Map = base;
+    buffer->m_MapLength = mapLength;
+    buffer->m_Data = static_cast<const char*>(base);
+    buffer->m_Length = length;
+    return buffer;
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::FromStream(std::istream& in) {
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return FromString(std::move(text));
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::FromString(std::string text) {
+    auto buffer = std::shared_ptr<SourceBuffer>(new SourceBuffer());
+    buffer->m_Owned = std::move(text);
+    buffer->m_Data = buffer->m_Owned.c_str();     // c_str() is always '\0' terminated
+    buffer->m_Length = buffer->m_Owned.size();
+    return buffer;
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::FromMemory(const char* data, size_t length) {
+    auto buffer = std::shared_ptr<SourceBuffer>(new SourceBuffer());
+    buffer->m_Data = data;
+    buffer->m_Length = length;
+    return buffer;
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::FromDescriptor(int fd, bool isOwned, size_t windowSize) {
+    auto buffer = std::shared_ptr<SourceBuffer>(new SourceBuffer());
+    buffer->m_Fd = fd;
+    buffer->m_IsFdOwned = isOwned;
+    buffer->m_IsExhausted = false;
+    buffer->m_WindowSize = windowSize;
+    buffer->m_Window.reset(new char[windowSize + SENTINEL_PADDING]());
+    buffer->m_Data = buffer->m_Window.get();
+    buffer->m_Lines.reset(new LineIndex());
+    std::call_once(buffer->m_LinesBuilt, [] { });     // Extended by Refill instead
+    const char* keep = buffer->m_Data;
+    buffer->Refill(keep);
+    return buffer;
+}
+
+bool SourceBuffer::Refill(const char*& keep) {
+    if (m_Fd < 0 || m_IsExhausted) return false;
+    char* window = m_Window.get();
+    size_t dropped = keep - m_Data;
+    size_t kept = m_Length - dropped;
+    if (kept == m_WindowSize) return false;
+    std::memmove(window, keep, kept);
+    m_Base += dropped;
+    m_Length = kept;
+    keep = window;
+
+    /* Nothing is read past MAX_LENGTH, one more byte there tells whether the input was cut off */
+    size_t room = std::min<unsigned long long>(m_WindowSize - m_Length, MAX_LENGTH - (m_Base + m_Length));
+    ssize_t n = 0;
+    if (room == 0) {
+        char probe;
+        do {
+            n = read(m_Fd, &probe, 1);
+        } while (n < 0 && errno == EINTR);
+        m_IsCutOff = n > 0;
+        n = 0;
+    }
+    else {
+        do {
+            n = read(m_Fd, window + m_Length, room);
+        } while (n < 0 && errno == EINTR);
+    }
+    if (n > 0) {
+        m_Lines->Append(window + m_Length, n, m_Base + m_Length);
+        m_Length += n;
+    }
+    else m_IsExhausted = true;      /* A read error ends the input like end of file does */
+    std::memset(window + m_Length, 0, SENTINEL_PADDING);
+    return n > 0;
+}
+
+const LineIndex& SourceBuffer::GetLines() {
+    std::call_once(m_LinesBuilt, [this] { m_Lines.reset(new LineIndex(m_Data, m_Length)); });
+    return *m_Lines;
+}
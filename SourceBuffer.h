@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "LineIndex.h"
+
+#pragma once
+
+// Read only view of a whole source file. The text is always followed by at least one '\0' sentinel
+// byte, so the Tokenizer can walk it with a raw pointer and never test for end of buffer explicitly.
+// A streaming buffer only holds a fixed size window of its input, see FromDescriptor and Refill.
+class SourceBuffer
+{
+    public:
+        static const size_t DEFAULT_WINDOW_SIZE = 1024 * 1024;
+        // Positions are 32 bit offsets, a longer input is cut off here, see IsCutOff.
+        static const unsigned long long MAX_LENGTH = 0xFFFFFFFFull;
+
+        // Memory maps a regular file, pipes, devices and files longer than MAX_LENGTH are streamed.
+        // Returns nullptr if the file can't be opened.
+        static std::shared_ptr<SourceBuffer> FromFile(const std::string& fileName);
+        // Reads the rest of an already open stream into an owned buffer.
+        static std::shared_ptr<SourceBuffer> FromStream(std::istream& in);
+        // Takes over a string, no copy of the text is made.
+        static std::shared_ptr<SourceBuffer> FromString(std::string text);
+        // Caller owned span, no copy is made. data[length] must be '\0' and must outlive the buffer.
+        static std::shared_ptr<SourceBuffer> FromMemory(const char* data, size_t length);
+        // Streams a pipe, socket or file through a window of windowSize bytes, memory use does not grow
+        // with the input. The descriptor is closed with the buffer if isOwned is set.
+        static std::shared_ptr<SourceBuffer> FromDescriptor(int fd, bool isOwned = false, size_t windowSize = DEFAULT_WINDOW_SIZE);
+
+        SourceBuffer(const SourceBuffer&) = delete;
+        SourceBuffer& operator=(const SourceBuffer&) = delete;
+        ~SourceBuffer();
+
+        const char* GetData() const { return m_Data; }
+        const char* GetEnd() const { return m_Data + m_Length; }
+        size_t GetLength() const { return m_Length; }
+        // Built on first use, safe to call from several threads. A streaming buffer extends it on
+        // every Refill, so it must only be used by the thread that reads the stream.
+        const LineIndex& GetLines();
+
+        bool IsStreaming() const { return m_Fd >= 0; }
+        // Offset of GetData() in the whole input, always 0 unless streaming.
+        unsigned long long GetBase() const { return m_Base; }
+        // Streaming only. Drops the text before keep, moves the rest to the front of the window and reads
+        // more input behind it. keep is updated to where the kept text is now. Returns false if nothing
+        // could be read, because the input has ended or because the kept text already fills the window.
+        bool Refill(const char*& keep);
+        bool IsExhausted() const { return m_IsExhausted; }
+        // Streaming only. The input went on past MAX_LENGTH, the rest was not read.
+        bool IsCutOff() const { return m_IsCutOff; }
+
+    private:
+        SourceBuffer();
+
+        const char* m_Data;
+        size_t m_Length;
+        void* m_Map;
+        size_t m_MapLength;
+        std::string m_Owned;
+        std::unique_ptr<LineIndex> m_Lines;
+        std::once_flag m_LinesBuilt;
+
+        int m_Fd;                               // Streaming input or -1
+        bool m_IsFdOwned;
+        bool m_IsExhausted;
+        bool m_IsCutOff;
+        unsigned long long m_Base;
+        std::unique_ptr<char[]> m_Window;
+        size_t m_WindowSize;
+};
@@ -0,0 +1,172 @@
+#include "SymbolFile.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "ASTArena.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Writing ////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+static ASTNode* identDefOf(const ASTNode* declaration) {
+    switch (declaration->GetKind()) {
+        case N_CONST_DECLARATION:
+        case N_TYPE_DECLARATION:        return declaration->GetChild(0);
+        case N_VARIABLE_DECLARATION:    return declaration->GetChild(0)->GetList()[0];
+        case N_PROCEDURE_HEADING:       return declaration->GetChild(1);
+        default:                        return nullptr;
+    }
+}
+
+static std::string exportName(const ASTNode* declaration, const NameTable& names) {
+    std::string name(names.GetName(identDefOf(declaration)->GetName()));
+    auto reciver = declaration->GetKind() == N_PROCEDURE_HEADING ? declaration->GetChild(0) : nullptr;
+    return reciver != nullptr ? std::string(names.GetName(reciver->GetName(1))) + "." + name : name;
+}
+
+static bool isExported(const ASTNode* identDef) {
+    return (identDef->GetFlags() & (NF_EXPORT | NF_READ_ONLY)) != 0;
+}
+
+// A variable declaration is split into one declaration per exported name, a procedure declaration
+// is cut down to its heading.
+static void addExports(ASTArena& arena, ASTNode* declaration, bool isDefinition, std::vector<ASTNode*>& exports) {
+    switch (declaration->GetKind()) {
+        case N_VARIABLE_DECLARATION:
+            for (auto identDef : declaration->GetChild(0)->GetList()) {
+                if (!isDefinition && !isExported(identDef)) continue;
+                auto identList = ASTNode::MakeIdentListNode(arena, 0, arena.MakeList(&identDef, 1));
+                exports.push_back(ASTNode::MakeVariableDeclarationNode(arena, 0, identList, declaration->GetChild(1)));
+            }
+            break;
+        case N_PROCEDURE_DECLARATION:
+            addExports(arena, declaration->GetChild(0), isDefinition, exports);
+            break;
+        case N_CONST_DECLARATION:
+        case N_TYPE_DECLARATION:
+        case N_PROCEDURE_HEADING:
+            if (isDefinition || isExported(identDefOf(declaration))) exports.push_back(declaration);
+            break;
+        default:
+            break;
+    }
+}
+
+bool SymbolFile::Write(const std::string& fileName, const ASTNode* root, const NameTable& names,
+                       unsigned long long sourceHash, unsigned long long sourceLength) {
+    if (root == nullptr || (root->GetKind() != N_MODULE && root->GetKind() != N_DEFINITION)) return false;
+    ASTArena arena;
+    std::vector<ASTNode*> exports;
+    if (root->GetKind() == N_MODULE) {
+        for (auto item : root->GetList()) {
+            if (item->GetKind() != N_DECLARATION_SEQUENCE) continue;
+            for (auto declaration : item->GetList()) addExports(arena, declaration, false, exports);
+        }
+    }
+    else if (root->GetChild(1) != nullptr) {
+        for (auto declaration : root->GetChild(1)->GetList()) addExports(arena, declaration, true, exports);
+    }
+
+    std::vector<std::pair<std::string, ASTNode*>> sorted;
+    for (auto declaration : exports) sorted.emplace_back(exportName(declaration, names), declaration);
+    std::stable_sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < sorted.size(); i++) exports[i] = sorted[i].second;
+
+    auto sequence = ASTNode::MakeDeclarationSequence2Node(arena, 0, arena.MakeList(exports.data(), exports.size()));
+    auto symbols = ASTNode::MakeDeclarationNode(arena, 0, root->GetName(), nullptr, sequence);
+    return ASTCache::Write(fileName, symbols, names, sourceHash, sourceLength, false);
+}
+
+std::string SymbolFile::GetFileName(const std::string& directory, std::string_view moduleName) {
+    return directory + "/" + std::string(moduleName) + ".obxs";
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reading ////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+SymbolFile::SymbolFile(std::shared_ptr<ASTCache> cache) {
+    m_Cache = cache;
+    m_Exports = cache->GetRoot().GetChild(1);
+}
+
+// True if declaration is one SymbolFile::Write makes: what Find and GetExportName read of it is
+// there and of the kind they read it as.
+static bool isWellFormed(ASTCacheNode declaration) {
+    if (declaration.IsNull()) return false;
+    switch (declaration.GetKind()) {
+        case N_CONST_DECLARATION:
+        case N_TYPE_DECLARATION:
+        case N_VARIABLE_DECLARATION:
+            break;
+        case N_PROCEDURE_HEADING:
+            if (!declaration.GetChild(0).IsNull() && declaration.GetChild(0).GetKind() != N_RECIVER) return false;
+            break;
+        default:
+            return false;
+    }
+    if (declaration.GetKind() == N_VARIABLE_DECLARATION
+        && (declaration.GetChild(0).IsNull() || declaration.GetChild(0).GetKind() != N_IDENT_LIST)) return false;
+    auto identDef = SymbolFile::GetIdentDef(declaration);
+    return !identDef.IsNull() && identDef.GetKind() == N_IDENT_DEF;
+}
+
+// A damaged file is no symbol file, its importers are compiled as if it were missing.
+std::shared_ptr<SymbolFile> SymbolFile::Open(const std::string& fileName) {
+    auto cache = ASTCache::Open(fileName);
+    if (cache == nullptr) return nullptr;
+    auto root = cache->GetRoot();
+    if (root.IsNull() || root.GetKind() != N_DEFINITION || root.GetChild(1).IsNull()
+        || root.GetChild(1).GetKind() != N_DECLARATION_SEQUENCE) return nullptr;
+    auto exports = root.GetChild(1);
+    for (unsigned int i = 0; i < exports.GetListLength(); i++) {
+        if (!isWellFormed(exports.GetListItem(0, i))) return nullptr;
+    }
+    return std::shared_ptr<SymbolFile>(new SymbolFile(cache));
+}
+
+// Compares the export name of declaration with name like std::string::compare, without putting the
+// export name together.
+static int compareExportName(ASTCacheNode declaration, std::string_view name) {
+    auto identDef = SymbolFile::GetIdentDef(declaration);
+    auto reciver = declaration.GetKind() == N_PROCEDURE_HEADING ? declaration.GetChild(0) : ASTCacheNode();
+    std::string_view pieces[3] = { identDef.GetName(), ".", identDef.GetName() };
+    if (!reciver.IsNull()) pieces[0] = reciver.GetName(1);
+    for (unsigned int i = 0; i < (reciver.IsNull() ? 1 : 3); i++) {
+        auto head = name.substr(0, pieces[i].size());
+        if (auto result = pieces[i].compare(head)) return result;
+        name.remove_prefix(head.size());
+    }
+    return name.empty() ? 0 : -1;
+}
+
+ASTCacheNode SymbolFile::Find(std::string_view name) const {
+    unsigned int low = 0, high = GetCount();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (compareExportName(GetExport(middle), name) < 0) low = middle + 1;
+        else high = middle;
+    }
+    if (low < GetCount() && compareExportName(GetExport(low), name) == 0) return GetExport(low);
+    return ASTCacheNode();
+}
+
+ASTCacheNode SymbolFile::GetIdentDef(ASTCacheNode declaration) {
+    switch (declaration.GetKind()) {
+        case N_CONST_DECLARATION:
+        case N_TYPE_DECLARATION:        return declaration.GetChild(0);
+        case N_VARIABLE_DECLARATION:    return declaration.GetChild(0).GetListItem(0, 0);
+        case N_PROCEDURE_HEADING:       return declaration.GetChild(1);
+        default:                        return ASTCacheNode();
+    }
+}
+
+std::string SymbolFile::GetExportName(ASTCacheNode declaration) {
+    auto identDef = GetIdentDef(declaration);
+    if (identDef.IsNull()) return std::string();
+    std::string name(identDef.GetName());
+    auto reciver = declaration.GetKind() == N_PROCEDURE_HEADING ? declaration.GetChild(0) : ASTCacheNode();
+    return !reciver.IsNull() ? std::string(reciver.GetName(1)) + "." + name : name;
+}
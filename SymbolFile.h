@@ -0,0 +1,51 @@
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "ASTCache.h"
+#include "ASTNode.h"
+#include "NameTable.h"
+
+#pragma once
+
+// The exported interface of one module or definition, what an importer needs instead of its source:
+// the exported constants, types, variables and procedure headings, without procedure bodies.
+//
+// A symbol file is an ASTCache file of a Definition node named after the module, holding one
+// declaration sequence. A variable declaration there has a single name, procedures are their
+// headings, and the declarations are sorted by export name: the name, or Type.name for a procedure
+// bound to a type. Nodes carry no positions, so editing a module body leaves its symbol file as it
+// was. Opening maps the file and reads nothing, Find looks a name up by binary search in place.
+class SymbolFile
+{
+    public:
+        // Maps a symbol file. Returns nullptr if it can't be read or is not a symbol file.
+        static std::shared_ptr<SymbolFile> Open(const std::string& fileName);
+        // Writes the exports of the module or definition under root, see ASTCache::Write. In a
+        // definition every declaration is exported, in a module those marked '*' or '-'.
+        static bool Write(const std::string& fileName, const ASTNode* root, const NameTable& names,
+                          unsigned long long sourceHash, unsigned long long sourceLength);
+        // <directory>/<module>.obxs
+        static std::string GetFileName(const std::string& directory, std::string_view moduleName);
+
+        // True if the symbol file was made from a source with this content.
+        bool Matches(unsigned long long sourceHash, unsigned long long sourceLength) const { return m_Cache->Matches(sourceHash, sourceLength); }
+        std::string_view GetModuleName() const { return m_Cache->GetRoot().GetName(); }
+        // Hash of the exports alone, the same as long as the exported declarations are. It does not
+        // change with the module body, positions or the order of declarations in the source.
+        unsigned long long GetFingerprint() const { return m_Cache->HashTree(); }
+        unsigned int GetCount() const { return m_Exports.GetListLength(); }
+        ASTCacheNode GetExport(unsigned int index) const { return m_Exports.GetListItem(0, index); }
+        // The exported declaration named name, a null handle if there is none.
+        ASTCacheNode Find(std::string_view name) const;
+
+        // The IdentDef of an exported declaration, and the name it is found by.
+        static ASTCacheNode GetIdentDef(ASTCacheNode declaration);
+        static std::string GetExportName(ASTCacheNode declaration);
+
+    private:
+        SymbolFile(std::shared_ptr<ASTCache> cache);
+
+        std::shared_ptr<ASTCache> m_Cache;
+        ASTCacheNode m_Exports;                 // The declaration sequence
+};
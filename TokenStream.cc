@@ -0,0 +1,182 @@
+#include "TokenStream.h"
+
+static const size_t TOKEN_BATCH_SIZE = 4096;
+
+TokenStream::TokenStream(std::shared_ptr<Tokenizer> lexer) {
+    m_Lexer = lexer;
+    m_Source = lexer->GetSource();
+    m_Names = lexer->GetNames();
+    m_Kinds.push_back(T_EOF);
+    m_Offsets.push_back(0);
+    m_Lengths.push_back(0);
+    m_Values.push_back(NO_ATOM);
+    m_Pos = 0;
+    m_Dropped = 0;
+    m_IsComplete = false;
+    m_IsStreaming = m_Source->IsStreaming();
+    m_IsInterning = false;
+    m_IsCancelled = false;
+}
+
+TokenStream::~TokenStream() {
+    m_IsCancelled = true;
+    if (m_Worker.joinable()) m_Worker.join();
+}
+
+// Lexes the rest of the file before the parser starts.
+void TokenStream::PreLex() {
+    size_t expected = m_Kinds.size() + m_Source->GetLength() / 4 + 16;
+    m_Kinds.reserve(expected);
+    m_Offsets.reserve(expected);
+    m_Lengths.reserve(expected);
+    m_Values.reserve(expected);
+    while (!m_IsComplete) pull();
+}
+
+// Starts a worker thread that lexes ahead in batches, the parser picks them up as it goes.
+void TokenStream::PreLexAsync() {
+    if (m_IsComplete || m_IsStreaming || m_Worker.joinable()) return;
+    m_Worker = std::thread(&TokenStream::lexWorker, this);
+}
+
+TokenCode TokenStream::PeekSymbol(size_t n) {
+    if (m_Pos + n >= m_Kinds.size()) fill(n);
+    size_t index = m_Pos + n;
+    return index < m_Kinds.size() ? static_cast<TokenCode>(m_Kinds[index]) : T_EOF;
+}
+
+unsigned int TokenStream::GetLine() {
+    return m_Source->GetLines().GetLine(m_Offsets[m_Pos]);
+}
+
+unsigned int TokenStream::GetColumn() {
+    return m_Source->GetLines().GetColumn(m_Offsets[m_Pos]);
+}
+
+std::string_view TokenStream::GetSpan() {
+    switch (m_Kinds[m_Pos]) {
+        case T_IDENT:
+            return m_Names->GetName(m_Values[m_Pos]);
+        case T_STRING:
+        case T_HEX_STRING:
+            if (IsInterning()) return m_Names->GetName(m_Values[m_Pos]);
+            return std::string_view(m_Source->GetData() + m_Offsets[m_Pos] + 1, m_Lengths[m_Pos] - 2);
+        default:
+            return std::string_view();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filling ////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Makes the token ahead tokens after the cursor valid if the file has that many, the cursor stays on
+// T_EOF at the end.
+void TokenStream::fill(size_t ahead) {
+    if (m_IsStreaming && m_Pos >= TOKEN_BATCH_SIZE) dropConsumed();
+    while (m_Pos + ahead >= m_Kinds.size() && !m_IsComplete) {
+        if (!m_Worker.joinable()) {
+            pull();
+            continue;
+        }
+
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> guard(m_Lock);
+            m_Ready.wait(guard, [this] { return !m_Batches.empty(); });
+            batch = std::move(m_Batches.front());
+            m_Batches.pop_front();
+        }
+        m_Kinds.insert(m_Kinds.end(), batch.kinds.begin(), batch.kinds.end());
+        m_Offsets.insert(m_Offsets.end(), batch.offsets.begin(), batch.offsets.end());
+        m_Lengths.insert(m_Lengths.end(), batch.lengths.begin(), batch.lengths.end());
+        unsigned int numberBase = m_Numbers.size();
+        for (size_t i = 0; i < batch.kinds.size(); i++) {
+            auto kind = batch.kinds[i];
+            m_Values.push_back(kind == T_NUMBER || kind == T_HEX_CHAR ? batch.values[i] + numberBase : batch.values[i]);
+        }
+        m_Numbers.insert(m_Numbers.end(), batch.numbers.begin(), batch.numbers.end());
+        if (m_Kinds.back() == T_EOF) {
+            m_IsComplete = true;
+            m_Worker.join();
+        }
+    }
+    if (m_Pos >= m_Kinds.size()) m_Pos = m_Kinds.size() - 1;
+}
+
+// Everything before the cursor. Numbers are appended in token order, so those of the dropped tokens
+// are the front of m_Numbers and the kept tokens index the rest.
+void TokenStream::dropConsumed() {
+    size_t numbers = m_Numbers.size();
+    for (size_t i = m_Pos; i < m_Kinds.size(); i++) {
+        if (m_Kinds[i] == T_NUMBER || m_Kinds[i] == T_HEX_CHAR) {
+            numbers = m_Values[i];
+            break;
+        }
+    }
+    m_Kinds.erase(m_Kinds.begin(), m_Kinds.begin() + m_Pos);
+    m_Offsets.erase(m_Offsets.begin(), m_Offsets.begin() + m_Pos);
+    m_Lengths.erase(m_Lengths.begin(), m_Lengths.begin() + m_Pos);
+    m_Values.erase(m_Values.begin(), m_Values.begin() + m_Pos);
+    for (size_t i = 0; i < m_Kinds.size(); i++) {
+        if (m_Kinds[i] == T_NUMBER || m_Kinds[i] == T_HEX_CHAR) m_Values[i] -= numbers;
+    }
+    m_Numbers.erase(m_Numbers.begin(), m_Numbers.begin() + numbers);
+    m_Dropped += m_Pos;
+    m_Pos = 0;
+}
+
+void TokenStream::pull() {
+    m_Lexer->Advance();
+    auto symbol = m_Lexer->GetSymbol();
+    m_Kinds.push_back(symbol);
+    m_Offsets.push_back(m_Lexer->GetOffset());
+    m_Lengths.push_back(m_Lexer->GetLength());
+    m_Values.push_back(valueOf(*m_Lexer, symbol, m_Numbers));
+    if (symbol == T_EOF) m_IsComplete = true;
+}
+
+unsigned int TokenStream::valueOf(Tokenizer& lexer, TokenCode symbol, std::vector<NumberValue>& numbers) {
+    switch (symbol) {
+        case T_IDENT:
+            return lexer.GetAtom();
+        case T_NUMBER:
+        case T_HEX_CHAR:
+            numbers.push_back(lexer.GetNumber());
+            return numbers.size() - 1;
+        case T_STRING:
+        case T_HEX_STRING:
+            return IsInterning() ? m_Names->Intern(lexer.GetSpan()) : NO_ATOM;
+        default:
+            return NO_ATOM;
+    }
+}
+
+void TokenStream::lexWorker() {
+    Batch batch;
+    bool isEndOfFile = false;
+    while (!isEndOfFile && !m_IsCancelled) {
+        batch.kinds.reserve(TOKEN_BATCH_SIZE);
+        batch.offsets.reserve(TOKEN_BATCH_SIZE);
+        batch.lengths.reserve(TOKEN_BATCH_SIZE);
+        batch.values.reserve(TOKEN_BATCH_SIZE);
+        while (batch.kinds.size() < TOKEN_BATCH_SIZE) {
+            m_Lexer->Advance();
+            auto symbol = m_Lexer->GetSymbol();
+            batch.kinds.push_back(symbol);
+            batch.offsets.push_back(m_Lexer->GetOffset());
+            batch.lengths.push_back(m_Lexer->GetLength());
+            batch.values.push_back(valueOf(*m_Lexer, symbol, batch.numbers));
+            if (symbol == T_EOF) {
+                isEndOfFile = true;
+                break;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            m_Batches.push_back(std::move(batch));
+        }
+        m_Ready.notify_one();
+        batch = Batch();
+    }
+}
@@ -0,0 +1,98 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Tokenizer.h"
+
+#pragma once
+
+// Token array in struct of arrays form, consumed by the Parser through an index cursor.
+// Tokens are pulled from the Tokenizer on demand (interleaved lex and parse), all at once with PreLex(),
+// or by a worker thread running ahead of the parser with PreLexAsync(). Line and column are not stored,
+// they are looked up from the token offset in the SourceBuffer's LineIndex when asked for.
+// A streaming source keeps only a window of the text, string literals are then interned in the
+// NameTable as they are lexed so their text outlives the window. Tokens behind the cursor of a
+// streaming source are dropped as the parser goes, so token memory is bounded by the lookahead and
+// not by the input, unless PreLex is asked to lex it all.
+class TokenStream
+{
+    public:
+        TokenStream(std::shared_ptr<Tokenizer> lexer);
+        ~TokenStream();
+
+        void PreLex();
+        // The lexer and its NameTable belong to the worker thread until T_EOF has been delivered.
+        // Streaming sources are always lexed on the parser's thread, this is a no-op for them.
+        void PreLexAsync();
+        // String literals are interned in the NameTable as for a streaming source, so nothing parsed
+        // from this stream views the text. Must be called before the first token is read.
+        void InternStrings() { m_IsInterning = true; }
+        bool IsInterning() { return m_IsStreaming || m_IsInterning; }
+
+        TokenCode GetSymbol() { return static_cast<TokenCode>(m_Kinds[m_Pos]); }
+        void Advance() { if (++m_Pos == m_Kinds.size()) fill(0); }
+        // Symbol n tokens ahead of the current one, lookahead past T_EOF returns T_EOF.
+        TokenCode PeekSymbol(size_t n);
+
+        unsigned int GetLine();
+        unsigned int GetColumn();
+        unsigned int GetOffset() { return m_Offsets[m_Pos]; }
+        unsigned int GetLength() { return m_Lengths[m_Pos]; }
+        // Text of a T_IDENT, or the contents of a T_STRING or T_HEX_STRING without delimiters, as
+        // Tokenizer::GetText. Empty for other tokens, the same for mapped and streaming sources.
+        std::string GetText() { return std::string(GetSpan()); }
+        // Zero-copy view of the same text, into the source buffer unless it is interned.
+        std::string_view GetSpan();
+        Atom GetAtom() { return m_Values[m_Pos]; }
+        NumberValue GetNumber() { return m_Numbers[m_Values[m_Pos]]; }
+
+        // Counted from the start of the source, dropped tokens included.
+        size_t GetIndex() { return m_Dropped + m_Pos; }
+        size_t GetCount() { return m_Dropped + m_Kinds.size(); }
+        std::shared_ptr<SourceBuffer> GetSource() { return m_Source; }
+        std::shared_ptr<NameTable> GetNames() { return m_Names; }
+
+    private:
+        // Token columns of one batch handed over by the worker thread.
+        struct Batch {
+            std::vector<unsigned char> kinds;
+            std::vector<unsigned int> offsets;
+            std::vector<unsigned int> lengths;
+            std::vector<unsigned int> values;
+            std::vector<NumberValue> numbers;
+        };
+
+        void fill(size_t ahead);
+        void dropConsumed();
+        void pull();
+        unsigned int valueOf(Tokenizer& lexer, TokenCode symbol, std::vector<NumberValue>& numbers);
+        void lexWorker();
+
+        std::shared_ptr<Tokenizer> m_Lexer;
+        std::shared_ptr<SourceBuffer> m_Source;
+        std::shared_ptr<NameTable> m_Names;
+
+        std::vector<unsigned char> m_Kinds;     // TokenCode, slot 0 is the state before the first Advance()
+        std::vector<unsigned int> m_Offsets;
+        std::vector<unsigned int> m_Lengths;
+        std::vector<unsigned int> m_Values;     // Atom of a T_IDENT, index into m_Numbers for T_NUMBER and T_HEX_CHAR,
+                                                // atom of the text of a T_STRING or T_HEX_STRING when streaming
+        std::vector<NumberValue> m_Numbers;
+        size_t m_Pos;
+        size_t m_Dropped;                       // Streaming only, tokens dropped from the front
+        bool m_IsComplete;                      // T_EOF has been appended
+        bool m_IsStreaming;
+        bool m_IsInterning;
+
+        std::thread m_Worker;
+        std::mutex m_Lock;
+        std::condition_variable m_Ready;
+        std::deque<Batch> m_Batches;
+        std::atomic<bool> m_IsCancelled;
+};
@@ -1,106 +1,189 @@
 
 #include "Tokenizer.h"
+#include "CharScan.h"
+#include "utf8.h"
 
+#include <charconv>
+#include <cstring>
 
-auto reservedKeywords = std::map<std::string, TokenCode>() = {
-    { "array", T_ARRAY },
-    { "ARRAY", T_ARRAY },
-    { "begin", T_BEGIN },
-    { "BEGIN", T_BEGIN },
-    { "by", T_BY },
-    { "BY", T_BY },
-    { "case", T_CASE },
-    { "CASE", T_CASE },
-    { "const", T_CONST },
-    { "CONST", T_CONST },
-    { "definition", T_DEFINITION },
-    { "DEFINITION", T_DEFINITION },
-    { "div", T_DIV },
-    { "DIV", T_DIV },
-    { "do", T_DO },
-    { "DO", T_DO },
-    { "else", T_ELSE },
-    { "ELSE", T_ELSE },
-    { "elsif", T_ELSIF },
-    { "ELSIF", T_ELSIF },
-    { "end", T_END },
-    { "END", T_END },
-    { "exit", T_EXIT },
-    { "EXIT", T_EXIT },
-    { "false", T_FALSE },
-    { "FALSE", T_FALSE },
-    { "for", T_FOR },
-    { "FOR", T_FOR },
-    { "if", T_IF },
-    { "IF", T_IF },
-    { "import", T_IMPORT },
-    { "IMPORT", T_IMPORT },
-    { "in", T_IN },
-    { "IN", T_IN },
-    { "is", T_IS },
-    { "IS", T_IS },
-    { "loop", T_LOOP },
-    { "LOOP", T_LOOP },
-    { "mod", T_MOD },
-    { "MOD", T_MOD },
-    { "module", T_MODULE },
-    { "MODULE", T_MODULE },
-    { "nil", T_NIL },
-    { "NIL", T_NIL },
-    { "of", T_OF },
-    { "OF", T_OF } ,
-    { "or", T_OR },
-    { "OR", T_OR },
-    { "pointer", T_POINTER },
-    { "POINTER", T_POINTER },
-    { "proc", T_PROC },
-    { "PROC", T_PROC },
-    { "procedure", T_PROCEDURE },
-    { "PROCEDURE", T_PROCEDURE },
-    { "record", T_RECORD },
-    { "RECORD", T_RECORD },
-    { "repeat", T_REPEAT },
-    { "REPEAT", T_REPEAT },
-    { "return", T_RETURN },
-    { "RETURN", T_RETURN },
-    { "then", T_THEN },
-    { "THEN", T_THEN },
-    { "to", T_TO },
-    { "TO", T_TO },
-    { "true", T_TRUE },
-    { "TRUE", T_TRUE },
-    { "type", T_TYPE },
-    { "TYPE", T_TYPE },
-    { "until", T_UNTIL },
-    { "UNTIL", T_UNTIL },
-    { "var", T_VAR },
-    { "VAR", T_VAR },
-    { "while", T_WHILE },
-    { "WHILE", T_WHILE },
-    { "with", T_WITH },
-    { "WITH", T_WITH }
-} ;
-
-
-
-Tokenizer::Tokenizer(const std::shared_ptr<std::ifstream> fin) { 
-    m_fin = fin;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reserved keywords //////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Keywords are either all lower case or all upper case, only the lower case spelling is stored.
+struct KeywordEntry {
+    const char* text;
+    unsigned int length;
+    TokenCode code;
+};
+
+static constexpr KeywordEntry keywordList[] = {
+    { "array", 5, T_ARRAY },        { "begin", 5, T_BEGIN },        { "by", 2, T_BY },
+    { "case", 4, T_CASE },          { "const", 5, T_CONST },        { "definition", 10, T_DEFINITION },
+    { "div", 3, T_DIV },            { "do", 2, T_DO },              { "else", 4, T_ELSE },
+    { "elsif", 5, T_ELSIF },        { "end", 3, T_END },            { "exit", 4, T_EXIT },
+    { "false", 5, T_FALSE },        { "for", 3, T_FOR },            { "if", 2, T_IF },
+    { "import", 6, T_IMPORT },      { "in", 2, T_IN },              { "is", 2, T_IS },
+    { "loop", 4, T_LOOP },          { "mod", 3, T_MOD },            { "module", 6, T_MODULE },
+    { "nil", 3, T_NIL },            { "of", 2, T_OF },              { "or", 2, T_OR },
+    { "pointer", 7, T_POINTER },    { "proc", 4, T_PROC },          { "procedure", 9, T_PROCEDURE },
+    { "record", 6, T_RECORD },      { "repeat", 6, T_REPEAT },      { "return", 6, T_RETURN },
+    { "then", 4, T_THEN },          { "to", 2, T_TO },              { "true", 4, T_TRUE },
+    { "type", 4, T_TYPE },          { "until", 5, T_UNTIL },        { "var", 3, T_VAR },
+    { "while", 5, T_WHILE },        { "with", 4, T_WITH }
+};
+
+static constexpr unsigned int KEYWORD_COUNT = sizeof(keywordList) / sizeof(keywordList[0]);
+static constexpr unsigned int KEYWORD_SLOT_BITS = 7;
+static constexpr unsigned int KEYWORD_SLOTS = 1u << KEYWORD_SLOT_BITS;
+static constexpr unsigned int KEYWORD_MAX_LENGTH = 10;
+
+// Mixes length, first, second and last character, folded to lower case. Every keyword has at least two characters.
+static constexpr unsigned int keywordHash(unsigned int seed, const char* text, unsigned int length) {
+    unsigned int key = (static_cast<unsigned char>(text[0]) | 0x20) << 24
+                     | (static_cast<unsigned char>(text[1]) | 0x20) << 16
+                     | (static_cast<unsigned char>(text[length - 1]) | 0x20) << 8
+                     | length;
+    return (key * seed) >> (32 - KEYWORD_SLOT_BITS);
+}
+
+struct KeywordTable {
+    unsigned int seed;
+    signed char slots[KEYWORD_SLOTS];   // Index into keywordList or -1
+};
+
+// Searches for a multiplier that maps every keyword to its own slot, runs entirely at compile time.
+static constexpr KeywordTable buildKeywordTable() {
+    for (unsigned int seed = 0x9E3779B1u; ; seed += 2) {
+        KeywordTable table = { seed, {} };
+        for (auto& slot : table.slots) slot = -1;
+        bool isPerfect = true;
+        for (unsigned int i = 0; i < KEYWORD_COUNT && isPerfect; i++) {
+            auto h = keywordHash(seed, keywordList[i].text, keywordList[i].length);
+            if (table.slots[h] >= 0) isPerfect = false;
+            else table.slots[h] = static_cast<signed char>(i);
+        }
+        if (isPerfect) return table;
+    }
+}
+
+static constexpr KeywordTable keywordTable = buildKeywordTable();
+
+// Returns the keyword token for text[0..length) or T_IDENT.
+static inline TokenCode lookupKeyword(const char* text, unsigned int length) {
+    if (length < 2 || length > KEYWORD_MAX_LENGTH) return T_IDENT;
+    auto index = keywordTable.slots[keywordHash(keywordTable.seed, text, length)];
+    if (index < 0) return T_IDENT;
+    auto& entry = keywordList[index];
+    if (entry.length != length) return T_IDENT;
+    char caseBit = text[0] & 0x20;  // 0 for upper case spelling
+    for (unsigned int i = 0; i < length; i++) {
+        if (text[i] != ((entry.text[i] & ~0x20) | caseBit)) return T_IDENT;
+    }
+    return entry.code;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Character classes //////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The scanning loops walk a local pointer and look bytes up here. Going through m_ch instead costs
+// a store per byte that the compiler can't keep in a register, a char store may alias m_Cur.
+// Characters that are a whole token on their own are dispatched with one lookup, not a branch each.
+enum : unsigned char { CHAR_BLANK = 1, CHAR_IDENT = 2, CHAR_SINGLE = 4 };
+
+struct CharClassTable {
+    unsigned char classes[256];
+    unsigned char tokens[256];      // TokenCode of a CHAR_SINGLE character
+};
+
+static constexpr CharClassTable buildCharClassTable() {
+    CharClassTable table = {};
+    for (int ch = 'a'; ch <= 'z'; ch++) table.classes[ch] = CHAR_IDENT;
+    for (int ch = 'A'; ch <= 'Z'; ch++) table.classes[ch] = CHAR_IDENT;
+    for (int ch = '0'; ch <= '9'; ch++) table.classes[ch] = CHAR_IDENT;
+    table.classes[static_cast<unsigned char>('_')] = CHAR_IDENT;
+    for (char ch : { ' ', '\t', '\r', '\n' }) table.classes[static_cast<unsigned char>(ch)] = CHAR_BLANK;
+    struct { char ch; TokenCode code; } singles[] = {
+        { ')', T_RIGHTPAREN }, { '[', T_LEFTBRACKET }, { ']', T_RIGHTBRACKET }, { '{', T_LEFTCURLY },
+        { '}', T_RIGHTCURLY }, { '*', T_MUL }, { '/', T_SLASH }, { '+', T_PLUS }, { '-', T_MINUS },
+        { ';', T_SEMICOLON }, { ',', T_COMMA }, { '#', T_HASH }, { '=', T_EQUAL }, { '^', T_ARROW },
+        { '|', T_BAR }, { '~', T_TILDE }, { '&', T_AND }
+    };
+    for (auto& single : singles) {
+        table.classes[static_cast<unsigned char>(single.ch)] = CHAR_SINGLE;
+        table.tokens[static_cast<unsigned char>(single.ch)] = static_cast<unsigned char>(single.code);
+    }
+    return table;
+}
+
+static constexpr CharClassTable charClasses = buildCharClassTable();
+
+static inline bool isBlank(char ch) { return charClasses.classes[static_cast<unsigned char>(ch)] & CHAR_BLANK; }
+
+static inline bool isIdentChar(char ch) { return charClasses.classes[static_cast<unsigned char>(ch)] & CHAR_IDENT; }
+
+Tokenizer::Tokenizer(const std::shared_ptr<SourceBuffer> source, std::shared_ptr<NameTable> names) { 
+    m_Source = source;
+    m_Names = names != nullptr ? names : std::make_shared<NameTable>();
+    m_Begin = m_Source->GetData();
+    m_Cur = m_Begin;
+    m_End = m_Source->GetEnd();
+    m_Base = m_Source->GetBase();
+    m_IsStreaming = m_Source->IsStreaming();
     m_Symbol = T_EOF;
-    m_Line = 1;
-    m_Col = 1;
-    m_ch = GetChar();
+    m_TokenStart = m_Cur;
+    m_Text = m_Cur;
+    m_TextLength = 0;
+    m_Atom = NO_ATOM;
+    m_Number.isReal = false;
+    m_Number.integer = 0;
+    m_ch = *m_Cur;
 }
 
+// Reads the whole stream up front, Advance() itself never touches iostreams.
+Tokenizer::Tokenizer(const std::shared_ptr<std::ifstream> fin, std::shared_ptr<NameTable> names) : Tokenizer(SourceBuffer::FromStream(*fin), names) { }
+
 TokenCode Tokenizer::GetSymbol() { return m_Symbol; }
 
-unsigned int Tokenizer::GetLine() { return m_Line; }
+// Line and column are not tracked while lexing, they are looked up from the token offset.
+unsigned int Tokenizer::GetLine() { return m_Source->GetLines().GetLine(GetOffset()); }
 
-unsigned int Tokenizer::GetColumn() { return m_Col; }
+unsigned int Tokenizer::GetColumn() { return m_Source->GetLines().GetColumn(GetOffset()); }
 
-std::string Tokenizer::GetText() { return m_Buffer; }
+unsigned int Tokenizer::GetOffset() { return m_TokenStart - m_Begin + m_Base; }
 
+void Tokenizer::Seek(unsigned int offset) {
+    m_Cur = m_Begin + offset;
+    m_TokenStart = m_Cur;
+    m_Symbol = T_EOF;
+    m_ch = *m_Cur;
+}
+
+unsigned int Tokenizer::GetLength() { return m_Cur - m_TokenStart; }
+
+std::string Tokenizer::GetText() { return std::string(m_Text, m_TextLength); }
+
+std::string_view Tokenizer::GetSpan() { return std::string_view(m_Text, m_TextLength); }
+
+Atom Tokenizer::GetAtom() { return m_Atom; }
+
+NumberValue Tokenizer::GetNumber() { return m_Number; }
+
+std::shared_ptr<SourceBuffer> Tokenizer::GetSource() { return m_Source; }
+
+std::shared_ptr<NameTable> Tokenizer::GetNames() { return m_Names; }
+
+// The buffer ends with a '\0' sentinel, we never step past it.
 char Tokenizer::GetChar() {
-    return m_ch = !m_fin->eof() ? m_fin->get() : '\0';   
+    return m_ch = m_ch != '\0' ? *++m_Cur : '\0';
+}
+
+// Moves forward to stop, stop must not be past the sentinel.
+inline void Tokenizer::skipTo(const char* stop) {
+    m_Cur = stop;
+    m_ch = *m_Cur;
 }
 
 bool Tokenizer::isStartLetter() {
@@ -109,89 +192,220 @@ bool Tokenizer::isStartLetter() {
     else return false;
 }
 
-bool Tokenizer::isLetterOrDigit() {
-    if (m_ch == '_' ) return true;
-    else if (m_ch >= '0' && m_ch <= '9') return true;
-    else if (isStartLetter()) return true;
-    else return false;
+static inline bool isDigit(char ch) { return ch >= '0' && ch <= '9'; }
+
+static inline bool isHexDigit(char ch) { return isDigit(ch) || (ch >= 'A' && ch <= 'F'); }
+
+// Rule: digit { digit } | digit { hexDigit } 'H' | digit { hexDigit } 'X' | digit { digit } '.' { digit } [ ( 'E' | 'D' ) [ '+' | '-' ] digit { digit } ]
+// The value is decoded straight from the source bytes into m_Number, malformed or too large numbers give T_ILLEGAL.
+TokenCode Tokenizer::scanNumber() {
+    const char* start = m_Cur;
+    const char* digitsEnd = start;
+    while (isDigit(*digitsEnd)) digitsEnd++;
+    const char* hexEnd = digitsEnd;
+    while (isHexDigit(*hexEnd)) hexEnd++;
+
+    TokenCode symbol = T_NUMBER;
+    const char* end = hexEnd;
+    m_Number.isReal = false;
+    if (*hexEnd == 'H' || *hexEnd == 'X') {
+        unsigned long long value = 0;
+        auto result = std::from_chars(start, hexEnd, value, 16);
+        m_Number.integer = static_cast<long long>(value);
+        end = hexEnd + 1;
+        if (result.ec != std::errc()) symbol = T_ILLEGAL;
+        else if (*hexEnd == 'X') symbol = value <= 0x10FFFF ? T_HEX_CHAR : T_ILLEGAL;
+    }
+    else if (hexEnd == digitsEnd && *digitsEnd == '.' && digitsEnd[1] != '.') { // '..' after an integer is a range
+        end = digitsEnd + 1;
+        while (isDigit(*end)) end++;
+        const char* scale = nullptr;
+        if (*end == 'E' || *end == 'D') {
+            const char* exponent = end + 1;
+            if (*exponent == '+' || *exponent == '-') exponent++;
+            if (isDigit(*exponent)) {
+                scale = end;
+                end = exponent;
+                while (isDigit(*end)) end++;
+            }
+        }
+        m_Number.isReal = true;
+        std::from_chars_result result;
+        if (scale != nullptr && *scale == 'D') {
+            /* from_chars only knows 'E', patch a copy on the stack, long reals are still plain doubles */
+            char patched[128];
+            size_t length = end - start;
+            if (length >= sizeof(patched)) result.ec = std::errc::result_out_of_range;
+            else {
+                std::memcpy(patched, start, length);
+                patched[scale - start] = 'E';
+                result = std::from_chars(patched, patched + length, m_Number.real);
+            }
+        }
+        else result = std::from_chars(start, end, m_Number.real);
+        if (result.ec != std::errc()) symbol = T_ILLEGAL;
+    }
+    else if (hexEnd != digitsEnd) symbol = T_ILLEGAL;     // Hex digits without 'H' or 'X'
+    else {
+        unsigned long long value = 0;
+        auto result = std::from_chars(start, digitsEnd, value, 10);
+        m_Number.integer = static_cast<long long>(value);
+        if (result.ec != std::errc() || value > 0x7FFFFFFFFFFFFFFFull) symbol = T_ILLEGAL;
+    }
+
+    skipTo(end);
+    return symbol;
+}
+
+// Rule: '"' { character } '"' | "'" { character } "'"
+// ASCII runs are skipped in bulk, only runs of non ASCII bytes are checked with utf8::find_invalid.
+// A UTF-8 sequence never contains an ASCII byte, so every run can be validated on its own.
+TokenCode Tokenizer::scanString() {
+    char quote = m_ch;
+    const char* start = m_Cur + 1;
+    const char* p = start;
+    bool isValid = true;
+    for (;;) {
+        p = ScanStringText(p, m_End, quote);
+        if ((*p & 0x80) == 0) break;
+        const char* run = p;
+        while (*p & 0x80) p++;      /* Stops at the sentinel at the latest */
+        if (utf8::find_invalid(run, p) != p) isValid = false;
+    }
+    m_Text = start; m_TextLength = p - start;
+    if (*p != quote) {              /* Strings end on the same line */
+        skipTo(p);
+        return T_ILLEGAL;
+    }
+    skipTo(p + 1);
+    return isValid ? T_STRING : T_ILLEGAL;
+}
+
+// Rule: '$' { hexDigit hexDigit } '$', blanks and line breaks between the digits are ignored.
+TokenCode Tokenizer::scanHexString() {
+    const char* start = m_Cur + 1;
+    const char* p = start;
+    unsigned int digits = 0;
+    bool isValid = true;
+    for ( ; *p != '$' && *p != '\0'; p++) {
+        if (isHexDigit(*p)) digits++;
+        else if (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') isValid = false;
+    }
+    m_Text = start; m_TextLength = p - start;
+    if (*p == '$') p++;
+    else isValid = false;
+    skipTo(p);
+    return isValid && digits % 2 == 0 ? T_HEX_STRING : T_ILLEGAL;
+}
+
+// How far past the end of a token the scanners may look, as in '1.5E+' followed by a digit.
+static const int TOKEN_LOOKAHEAD = 3;
+
+// Streaming only: keeps the text from m_TokenStart on, moves it to the front of the window and reads more.
+bool Tokenizer::refill() {
+    const char* keep = m_TokenStart;
+    bool isRead = m_Source->Refill(keep);
+    auto shift = m_TokenStart - keep;
+    m_Text = m_Text >= m_TokenStart ? m_Text - shift : keep;
+    m_Cur -= shift;
+    m_TokenStart = keep;
+    m_Begin = m_Source->GetData();
+    m_End = m_Source->GetEnd();
+    m_Base = m_Source->GetBase();
+    m_ch = *m_Cur;
+    return isRead;
 }
 
 // Get next valid symbol for parser
 void Tokenizer::Advance() {
+    lexToken();
 
-_whitespace: 
-    /* Remove whitespace */
-    while (m_ch == ' ' || m_ch == '\t') {
-        m_Col++; m_ch = GetChar();
+    /* A token that ends close to the end of a streaming window may go on in the next block, read more and lex it again */
+    while (m_End - m_Cur < TOKEN_LOOKAHEAD && m_IsStreaming && m_Symbol != T_EOF) {
+        if (!refill()) {
+            if (m_Cur == m_End && !m_Source->IsExhausted()) m_Symbol = T_ILLEGAL;   /* Token longer than the whole window */
+            return;
+        }
+        skipTo(m_TokenStart);
+        lexToken();
     }
+}
 
-    /* Handle newline */
-    if (m_ch == '\r' || m_ch == '\n') {
-        if (m_ch == '\r') {
-            m_ch = GetChar();
-            if (m_ch == '\n') {
-                m_ch = GetChar();
+void Tokenizer::lexToken() {
+
+_whitespace: 
+    /* Remove whitespace and line breaks, short runs inline and long runs in bulk */
+    if (isBlank(m_ch)) {
+        const char* p = m_Cur + 1;
+        for (int i = 1; isBlank(*p); i++, p++) {
+            if (i == 8) {
+                p = ScanWhitespace(p, m_End);
+                break;
             }
         }
-        else m_ch = GetChar();
-        m_Line++; m_Col = 1;
-        goto _whitespace;
+        skipTo(p);
     }
 
+    m_TokenStart = m_Cur;
+
     /* Handle End Of File */
     if (m_ch == '\0') {
+        if (m_Cur == m_End && m_IsStreaming && refill()) goto _whitespace;
         m_Symbol = T_EOF;
         return;
     }
 
+    /* Operators and delimiters of one character */
+    auto single = static_cast<unsigned char>(m_ch);
+    if (charClasses.classes[single] & CHAR_SINGLE) {
+        m_Symbol = static_cast<TokenCode>(charClasses.tokens[single]);
+        m_ch = GetChar();
+        return;
+    }
+
     /* Literal or reserved keywords */
     if (m_ch == '_' || isStartLetter()) {
-        m_Buffer.clear();
-        m_Buffer += m_ch; m_ch = GetChar(); m_Col++;
-        while (isLetterOrDigit()) {
-            m_Buffer += m_ch; m_Col++; m_ch = GetChar();
-        }
-        auto it = reservedKeywords.find(m_Buffer.c_str());
-        if (it != reservedKeywords.end()) {
-            m_Symbol = it->second;
-        }
-        else {
-            m_Symbol = T_IDENT;
-        }
+        auto start = m_Cur;
+        const char* p = m_Cur + 1;
+        while (isIdentChar(*p)) p++;    /* Stops at the sentinel at the latest */
+        skipTo(p);
+        m_Text = start; m_TextLength = m_Cur - start;
+        m_Symbol = lookupKeyword(start, m_TextLength);
+        if (m_Symbol == T_IDENT) m_Atom = m_Names->Intern(start, m_TextLength);
+        return;
+    }
+
+    /* Number, real or character constant */
+    if (m_ch >= '0' && m_ch <= '9') {
+        m_Symbol = scanNumber();
         return;
     }
 
-    /* Operator or delimiters */
+    /* Operators that may go on, strings and anything else */
     switch (m_ch) {
         case '(' :
             {
                 m_ch = GetChar();
-                m_Col++;
                 if (m_ch == '*') {
-                    m_Col++;
                     m_ch = GetChar();
 _comment:
-                    while (m_ch != '*') {
-                        if (m_ch == '\r' || m_ch == '\n') {
-                            if (m_ch == '\r') {
-                                m_ch = GetChar();
-                                if (m_ch == '\n') {
-                                    m_ch = GetChar();
-                                }
-                            }
-                            else m_ch = GetChar();
-                            m_Line++; m_Col = 1;
+                    skipTo(ScanCommentText(m_Cur, m_End));  /* Jump to next '*' or end of buffer */
+                    if (m_ch == '\0') {
+                        m_TokenStart = m_Cur;               /* Comment text is not kept over a refill */
+                        if (m_Cur == m_End && m_IsStreaming && refill()) goto _comment;
+                        m_Symbol = T_EOF;
+                        return;
+                    }
+                    m_ch = GetChar();
+                    if (m_ch == '\0' && m_Cur == m_End && m_IsStreaming) {
+                        m_TokenStart = m_Cur - 1;           /* Keep the '*', the ')' may be in the next block */
+                        if (refill()) {
+                            skipTo(m_TokenStart);
                             goto _comment;
                         }
-                        if (m_ch == '\0') {
-                            m_Symbol = T_EOF;
-                            return;
-                        }
-                        m_Col++; m_ch = GetChar();
                     }
-                    m_Col++; m_ch = GetChar();
                     if (m_ch == ')') {
-                        m_Col++; m_ch = GetChar();
+                        m_ch = GetChar();
                         goto _whitespace;
                     }
                     else goto _comment;
@@ -200,102 +414,48 @@ _comment:
                 return;
             }
             break;
-        case ')' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_RIGHTPAREN;
-            return;
-        case '[' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_LEFTBRACKET;
-            return;
-        case ']' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_RIGHTBRACKET;
-            return;
-        case '{' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_LEFTCURLY;
-            return;
-        case '}' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_RIGHTCURLY;
-            return;
-        case '*' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_MUL;
-            return;
-        case '/' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_SLASH;
-            return;
-        case '+' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_PLUS;
-            return;
-        case '-' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_MINUS;
-            return;
         case ':' :    
-            m_Col++; m_ch = GetChar();
+            m_ch = GetChar();
             if (m_ch == '=') {
-                m_Col++; m_ch = GetChar();
+                m_ch = GetChar();
                 m_Symbol = T_ASSIGN;
             }
             else m_Symbol = T_COLON;
             return;
-        case ';' :    
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_SEMICOLON;
-            return;
         case '.' : 
-            m_Col++; m_ch = GetChar();
+            m_ch = GetChar();
             if (m_ch == '.') {
-                m_Col++; m_ch = GetChar();
+                m_ch = GetChar();
                 m_Symbol = T_UPTO;
             }
             else m_Symbol = T_DOT;
             return;
-        case ',' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_COMMA;
-            return;
-        case '#' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_HASH;
-            return;
         case '<' :
-            m_Col++; m_ch = GetChar();
+            m_ch = GetChar();
             if (m_ch == '=') {
-                m_Col++; m_ch = GetChar();
+                m_ch = GetChar();
                 m_Symbol = T_LESSEQUAL;
             }
             else m_Symbol = T_LESS;
             return;
         case '>' :
-            m_Col++; m_ch = GetChar();
+            m_ch = GetChar();
             if (m_ch == '=') {
-                m_Col++; m_ch = GetChar();
+                m_ch = GetChar();
                 m_Symbol = T_GREATEREQUAL;
             }
             else m_Symbol = T_GREATER;
             return;
-        case '=' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_EQUAL;
-            return;
-        case '^' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_ARROW;
+        case '"' :
+        case '\'' :
+            m_Symbol = scanString();
             return;
-        case '|' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_BAR;
+        case '$' :
+            m_Symbol = scanHexString();
             return;
-        case '~' :
-            m_Col++; m_ch = GetChar();
-            m_Symbol = T_TILDE;
+        default:
+            m_ch = GetChar();
+            m_Symbol = T_ILLEGAL;
             return;
-        default:    break;
     }
 }
\ No newline at end of file
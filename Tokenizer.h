@@ -1,9 +1,12 @@
 
-#include <map>
 #include <string>
 #include <fstream>
 #include <memory>
 #include <string>
+#include <string_view>
+
+#include "NameTable.h"
+#include "SourceBuffer.h"
 
 #pragma once
 
@@ -13,32 +16,65 @@ typedef enum {
     T_REPEAT, T_RETURN, T_TO, T_TRUE, T_TYPE, T_THEN, T_UNTIL, T_VAR, T_WHILE, T_WITH, T_MINUS, T_COMMA, T_SEMICOLON,
     T_COLON, T_ASSIGN, T_DOT, T_UPTO, T_LEFTPAREN, T_RIGHTPAREN, T_LEFTBRACKET, T_RIGHTBRACKET, T_LEFTCURLY, T_RIGHTCURLY,
     T_MUL, T_SLASH, T_HASH, T_ARROW, T_PLUS, T_LESSEQUAL, T_EGUAL, T_GREATEREQUAL, T_BAR, T_TILDE, T_LESS, T_GREATER,
-    T_EQUAL, T_AND, T_IDENT, T_NUMBER, T_STRING, T_HEX_STRING, T_HEX_CHAR, T_EOF
+    T_EQUAL, T_AND, T_IDENT, T_NUMBER, T_STRING, T_HEX_STRING, T_HEX_CHAR, T_ILLEGAL, T_EOF
 } TokenCode;
 
+// Decoded value of a T_NUMBER or T_HEX_CHAR token, kept with the token so nobody has to re-read the digits.
+struct NumberValue {
+    bool isReal;
+    union {
+        long long integer;      // Hex numbers use all 64 bits
+        double real;
+    };
+};
 
 
 class Tokenizer
 {
     private:
-        std::shared_ptr<std::ifstream> m_fin;
+        std::shared_ptr<SourceBuffer> m_Source;
+        std::shared_ptr<NameTable> m_Names;
+        const char* m_Begin;    // Start of the source buffer, or of the window when streaming
+        const char* m_Cur;      // Position of m_ch in the source buffer
+        const char* m_End;      // The '\0' sentinel
+        unsigned long long m_Base;  // Input offset of m_Begin
+        bool m_IsStreaming;
+        const char* m_TokenStart;
         TokenCode m_Symbol;
-        unsigned int m_Line;
-        unsigned int m_Col;
-        std::string m_Buffer;
+        const char* m_Text;     // Span of the last identifier, or string contents without the delimiters
+        unsigned int m_TextLength;
+        Atom m_Atom;            // Interned name of the last T_IDENT
+        NumberValue m_Number;   // Value of the last T_NUMBER or T_HEX_CHAR
         char m_ch;
 
     public:
-        Tokenizer(const std::shared_ptr<std::ifstream> fin);
+        Tokenizer(const std::shared_ptr<SourceBuffer> source, std::shared_ptr<NameTable> names = nullptr);
+        Tokenizer(const std::shared_ptr<std::ifstream> fin, std::shared_ptr<NameTable> names = nullptr);
         TokenCode GetSymbol();
         void Advance();
-        unsigned int GetLine();
+        // Lexing goes on from offset, which must not be inside a token or a comment. Only for whole
+        // buffers, a streaming source can't go back.
+        void Seek(unsigned int offset);
+        unsigned int GetLine();         // Of the current token, looked up on demand
         unsigned int GetColumn();
+        unsigned int GetOffset();       // Byte offset of the current token
+        unsigned int GetLength();       // Length in bytes of the current token
+        // Text of the current identifier or string, when streaming it is only valid until the next Advance()
         std::string GetText();
+        std::string_view GetSpan();     // Same text as GetText, pointing into the source buffer
+        Atom GetAtom();
+        NumberValue GetNumber();
+        std::shared_ptr<SourceBuffer> GetSource();
+        std::shared_ptr<NameTable> GetNames();
 
     private:
         char GetChar();
+        void lexToken();
+        bool refill();
+        void skipTo(const char* stop);
         bool isStartLetter();
-        bool isLetterOrDigit();
+        TokenCode scanNumber();
+        TokenCode scanString();
+        TokenCode scanHexString();
 
 };
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "WorkScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+WorkScheduler::WorkScheduler(unsigned int workers) {
+    m_Workers = workers != 0 ? workers : std::max(1u, std::thread::hardware_concurrency());
+    m_WallSeconds = 0.0;
+    m_Graph = nullptr;
+    m_Task = nullptr;
+    m_Priority = nullptr;
+    m_Ready = 0;
+    m_Done = 0;
+}
+
+void WorkScheduler::Run(const ModuleGraph& graph, const std::function<void(size_t node, unsigned int worker)>& task,
+                        const std::vector<double>& priority) {
+    auto start = std::chrono::steady_clock::now();
+    m_Graph = &graph;
+    m_Task = &task;
+    m_Priority = &priority;
+    m_Queues = std::vector<Queue>(m_Workers);
+    m_Stats.assign(m_Workers, WorkerStats { 0.0, 0, 0 });
+    m_Waits.resize(graph.GetCount());
+    m_Done = 0;
+
+    std::vector<size_t> ready;
+    for (size_t node = 0; node < graph.GetCount(); node++) {
+        m_Waits[node] = graph.GetImports(node).size();
+        if (m_Waits[node] == 0) ready.push_back(node);
+    }
+    std::stable_sort(ready.begin(), ready.end(), [this](size_t a, size_t b) { return priorityOf(a) > priorityOf(b); });
+    for (size_t i = 0; i < ready.size(); i++) m_Queues[i % m_Workers].nodes.push_front(ready[i]);
+    m_Ready = ready.size();
+
+    std::vector<std::thread> pool;
+    for (unsigned int worker = 1; worker < m_Workers && worker < graph.GetCount(); worker++) pool.emplace_back(&WorkScheduler::work, this, worker);
+    work(0);
+    for (auto& thread : pool) thread.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    m_WallSeconds = elapsed.count();
+    m_Queues.clear();
+}
+
+double WorkScheduler::priorityOf(size_t node) const {
+    return node < m_Priority->size() ? (*m_Priority)[node] : 0.0;
+}
+
+// The newest node of the own deque, else the oldest of the next worker that has one.
+bool WorkScheduler::take(unsigned int worker, size_t& node) {
+    for (unsigned int i = 0; i < m_Workers; i++) {
+        auto& queue = m_Queues[(worker + i) % m_Workers];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.nodes.empty()) continue;
+        if (i == 0) {
+            node = queue.nodes.back();
+            queue.nodes.pop_back();
+        }
+        else {
+            node = queue.nodes.front();
+            queue.nodes.pop_front();
+            m_Stats[worker].steals++;
+        }
+        m_Ready--;
+        return true;
+    }
+    return false;
+}
+
+void WorkScheduler::work(unsigned int worker) {
+    auto count = m_Graph->GetCount();
+    std::vector<size_t> ready;
+    for (;;) {
+        size_t node;
+        if (!take(worker, node)) {
+            std::unique_lock<std::mutex> guard(m_Lock);
+            m_Wake.wait(guard, [this, count] { return m_Done == count || m_Ready > 0; });
+            if (m_Done == count) return;
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        (*m_Task)(node, worker);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        m_Stats[worker].busySeconds += elapsed.count();
+        m_Stats[worker].tasks++;
+
+        // Pushed lowest priority first, the back of the deque is taken first.
+        ready.clear();
+        bool isFinished;
+        {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            for (auto importer : m_Graph->GetImporters(node)) {
+                if (--m_Waits[importer] == 0) ready.push_back(importer);
+            }
+            std::stable_sort(ready.begin(), ready.end(), [this](size_t a, size_t b) { return priorityOf(a) < priorityOf(b); });
+            {
+                std::lock_guard<std::mutex> queueGuard(m_Queues[worker].lock);
+                for (auto importer : ready) m_Queues[worker].nodes.push_back(importer);
+            }
+            m_Ready += ready.size();
+            isFinished = ++m_Done == count;
+        }
+        if (ready.size() > 1 || isFinished) m_Wake.notify_all();
+    }
+}
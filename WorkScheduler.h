@@ -0,0 +1,66 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "ModuleGraph.h"
+
+#pragma once
+
+// What one worker thread of a WorkScheduler did.
+struct WorkerStats {
+    double busySeconds;                     // Time spent inside tasks
+    size_t tasks;
+    size_t steals;                          // Tasks taken from the deque of another worker
+};
+
+// Runs one task per node of a ModuleGraph on a fixed number of threads, a node only after all the
+// nodes it imports are done. Every worker has its own deque of ready nodes. A finished node makes
+// its importers ready on the worker that finished it, and that worker takes the newest node of its
+// deque next, so a module tends to be compiled by the thread that just did its import. A worker with
+// an empty deque steals the oldest node from another. At the start the ready nodes are dealt out in
+// priority order, the highest first.
+class WorkScheduler
+{
+    public:
+        // With workers 0 there is one thread per hardware thread.
+        WorkScheduler(unsigned int workers = 0);
+
+        // Calls task(node, worker) once for every node of graph, which must be acyclic. Nodes made
+        // ready together are started in order of priority, an empty priority is all equal.
+        void Run(const ModuleGraph& graph, const std::function<void(size_t node, unsigned int worker)>& task,
+                 const std::vector<double>& priority = {});
+
+        unsigned int GetWorkerCount() const { return m_Workers; }
+        // Of the last Run.
+        double GetWallSeconds() const { return m_WallSeconds; }
+        const std::vector<WorkerStats>& GetStats() const { return m_Stats; }
+
+    private:
+        struct Queue {
+            std::mutex lock;
+            std::deque<size_t> nodes;
+        };
+
+        double priorityOf(size_t node) const;
+        bool take(unsigned int worker, size_t& node);
+        void work(unsigned int worker);
+
+        unsigned int m_Workers;
+        double m_WallSeconds;
+        std::vector<WorkerStats> m_Stats;
+
+        // State of the running Run.
+        const ModuleGraph* m_Graph;
+        const std::function<void(size_t, unsigned int)>* m_Task;
+        const std::vector<double>* m_Priority;
+        std::vector<Queue> m_Queues;
+        std::vector<size_t> m_Waits;            // Imports of each node that are not done yet
+        std::atomic<size_t> m_Ready;            // Nodes in all deques, only raised under m_Lock
+        std::mutex m_Lock;                      // Guards m_Waits and m_Done
+        std::condition_variable m_Wake;         // Work was queued or the last node is done
+        size_t m_Done;
+};
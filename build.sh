@@ -1,11 +1,12 @@
 #!/bin/bash
 
 echo "Building the Gnu G++ version"
- g++ -o obx main.cc Tokenizer.cc Parser.cc ASTNode.cc
+ g++ -std=c++17 -O2 -pthread -o obx main.cc SourceBuffer.cc LineIndex.cc CharScan.cc NameTable.cc Tokenizer.cc TokenStream.cc Parser.cc ASTNode.cc ASTArena.cc ASTShareTable.cc ASTCache.cc ContentHash.cc IncrementalParser.cc CompileDriver.cc ModuleGraph.cc WorkScheduler.cc SymbolFile.cc BuildRecord.cc CompileCache.cc CompileServer.cc
  strip obx
+ g++ -std=c++17 -O2 -pthread -o obx_bench Benchmark.cc CorpusGenerator.cc SourceBuffer.cc LineIndex.cc CharScan.cc NameTable.cc Tokenizer.cc TokenStream.cc Parser.cc ASTNode.cc ASTArena.cc ASTShareTable.cc ASTCache.cc ContentHash.cc IncrementalParser.cc CompileDriver.cc ModuleGraph.cc WorkScheduler.cc SymbolFile.cc BuildRecord.cc CompileCache.cc CompileServer.cc
  
  echo "Building the clang++ version"
- clang++ -o obx_clang main.cc Tokenizer.cc Parser.cc ASTNode.cc
+ clang++ -std=c++17 -O2 -pthread -o obx_clang main.cc SourceBuffer.cc LineIndex.cc CharScan.cc NameTable.cc Tokenizer.cc TokenStream.cc Parser.cc ASTNode.cc ASTArena.cc ASTShareTable.cc ASTCache.cc ContentHash.cc IncrementalParser.cc CompileDriver.cc ModuleGraph.cc WorkScheduler.cc SymbolFile.cc BuildRecord.cc CompileCache.cc CompileServer.cc
  strip obx_clang
 
  ls -la obx*
@@ -1,24 +1,106 @@
-
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
-#include <memory>
-
-#include "Tokenizer.h"
-#include "Parser.h"
+#include <string>
+#include <vector>
 
-extern std::map<std::string, TokenCode> reservedKeywords;
+#include "CompileDriver.h"
+#include "CompileServer.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-    std::cout << "OberonX Compiler, Version 0.01" << std::endl;
+    std::cout << "OberonX Compiler, Version " << COMPILER_VERSION << std::endl;
     std::cout << "Written by Richard Magnor Stenbro. All rights reserved!" << std::endl << std::endl;
 
-    std::cout << reservedKeywords.size()<< std::endl;
+    /* obx [--ast-cache] [--check] [--schedule] [--symbols dir] [--cache dir [--cache-size MB]] [-j n]
+       [file | directory ...], '-' reads the source from stdin, a generator can pipe straight into the compiler.
+       Directories are searched for *.obx files, the files are compiled in parallel on n threads, one per hardware
+       thread by default, each module after the modules it imports.
+       With --ast-cache the tree is kept in <file>.obxc and an unchanged file is not lexed or parsed again.
+       With --check the parser recovers from syntax errors and all of them are reported in one run.
+       With --symbols the exports of every module are kept in dir/<module>.obxs, and the names a module uses from
+       its imports are looked up there.
+       With --cache the outputs of every clean compile are shared through a content addressed cache in dir, kept
+       to 1024 MB unless --cache-size says otherwise, and a module whose outputs are found there is not compiled.
+       With --schedule the critical path through the imports and the load of every thread are printed.
+       With --server the compiler stays resident on the Unix domain socket, compiles the inputs given, if any, and
+       then every build sent to it with --connect, remembering each file between builds, until --stop. The options
+       of the server hold for every build, a client only gives its inputs and --schedule. */
+    bool isCached = false, isChecking = false, isScheduleShown = false;
+    unsigned int workers = 0;
+    std::string symbolDirectory, cacheDirectory, serverSocket, clientSocket, stopSocket;
+    unsigned long long cacheSize = 1024;
+    std::vector<std::string> inputs;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string option = argv[arg];
+        if (option == "--ast-cache") isCached = true;
+        else if (option == "--check") isChecking = true;
+        else if (option == "--schedule") isScheduleShown = true;
+        else if (option == "--symbols" && arg + 1 < argc) symbolDirectory = argv[++arg];
+        else if (option == "--cache" && arg + 1 < argc) cacheDirectory = argv[++arg];
+        else if (option == "--cache-size" && arg + 1 < argc) cacheSize = std::strtoull(argv[++arg], nullptr, 10);
+        else if (option == "--server" && arg + 1 < argc) serverSocket = argv[++arg];
+        else if (option == "--connect" && arg + 1 < argc) clientSocket = argv[++arg];
+        else if (option == "--stop" && arg + 1 < argc) stopSocket = argv[++arg];
+        else if (option == "-j" && arg + 1 < argc) workers = std::atoi(argv[++arg]);
+        else inputs.push_back(option);
+    }
+    if (!stopSocket.empty()) {
+        if (CompileServer::Stop(stopSocket)) return 0;
+        std::cout << "No compile server on '" << stopSocket << "'!" << std::endl;
+        return 1;
+    }
+    if (inputs.empty() && serverSocket.empty()) inputs.push_back("./test.obx");
+
+    // The server runs in its own working directory.
+    if (!clientSocket.empty()) {
+        std::error_code error;
+        for (auto& input : inputs) {
+            if (input == "-") {
+                std::cout << "Standard input can't be sent to a compile server!" << std::endl;
+                return 1;
+            }
+            input = std::filesystem::absolute(input, error).lexically_normal().string();
+        }
+        auto status = CompileServer::Send(clientSocket, inputs, isScheduleShown, std::cout);
+        if (status >= 0) return status;
+        std::cout << "No compile server on '" << clientSocket << "'!" << std::endl;
+        return 1;
+    }
 
-    auto fin = std::make_shared<std::ifstream>("./test.obx");
+    CompileDriver driver(workers);
+    if (isCached) driver.EnableCaching();
+    if (isChecking) driver.EnableRecovery();
+    if (!symbolDirectory.empty() && !driver.SetSymbolDirectory(symbolDirectory)) {
+        std::cout << "Can't make symbol file directory '" << symbolDirectory << "'!" << std::endl;
+        return 1;
+    }
+    if (!cacheDirectory.empty() && !driver.SetCacheDirectory(cacheDirectory, cacheSize << 20)) {
+        std::cout << "Can't make compile cache directory '" << cacheDirectory << "'!" << std::endl;
+        return 1;
+    }
+    for (auto& input : inputs) {
+        if (!driver.AddInput(input)) {
+            std::cout << "Can't open source file '" << input << "'!" << std::endl;
+            return 1;
+        }
+    }
 
-    auto lexer = std::make_shared<Tokenizer>(Tokenizer(fin));
-    auto parser = std::make_shared<Parser>(Parser(lexer));
-    auto node = parser->ParseOberon();
+    if (!serverSocket.empty()) {
+        driver.EnableResidentState();
+        if (!inputs.empty()) {
+            driver.Run();
+            driver.Report(std::cout);
+            if (isScheduleShown) driver.ReportSchedule(std::cout);
+        }
+        CompileServer server(driver, serverSocket);
+        if (server.Run()) return 0;
+        std::cout << "Can't listen on '" << serverSocket << "'!" << std::endl;
+        return 1;
+    }
 
-    return 0;
-}
\ No newline at end of file
+    auto failed = driver.Run();
+    driver.Report(std::cout);
+    if (isScheduleShown) driver.ReportSchedule(std::cout);
+    return failed == 0 ? 0 : 1;
+}